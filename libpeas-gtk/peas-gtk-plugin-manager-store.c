@@ -26,6 +26,8 @@
 #include <config.h>
 #endif
 
+#include <string.h>
+
 #include <gio/gio.h>
 
 #include <libpeas/peas-plugin-info.h>
@@ -46,10 +48,58 @@ static const GType ColumnTypes[] = {
 
 G_STATIC_ASSERT (G_N_ELEMENTS (ColumnTypes) == PEAS_GTK_PLUGIN_MANAGER_STORE_N_COLUMNS);
 
+typedef struct {
+  GIcon *gicon;
+  gchar *stock_id;
+} CachedIcon;
+
 typedef struct {
   PeasEngine *engine;
+
+  /* The resolved icons keyed by their path in
+   * the plugin's data dir, cleared when the
+   * icon theme changes
+   */
+  GHashTable *icon_cache;
+
+  /* Shown for the plugins which are not available */
+  CachedIcon *error_icon;
+
+  /* The PeasPluginInfo of each row to its PluginRow */
+  GHashTable *plugin_rows;
+
+  /* The last search and its normalized form, the
+   * search is done once for every row per key press
+   */
+  gchar *search_key;
+  gchar *normalized_search_key;
+
+  /* The rows are updated at once after
+   * a batch of plugins are toggled
+   */
+  guint in_toggle_batch : 1;
 } PeasGtkPluginManagerStorePrivate;
 
+typedef struct {
+  /* Follows the row as it is sorted */
+  GtkTreeRowReference *reference;
+
+  /* So sorting does not have to collate the names */
+  gchar *collate_key;
+
+  /* The normalized name and the sorted normalized words
+   * of the name, description, authors and module name
+   */
+  gchar *search_name;
+  GPtrArray *search_words;
+
+  /* Computed when the row is first shown and cleared
+   * when it is updated, the icon is owned by the store
+   */
+  gchar *markup;
+  CachedIcon *icon;
+} PluginRow;
+
 /* Properties */
 enum {
   PROP_0,
@@ -59,117 +109,278 @@ enum {
 
 static GParamSpec *properties[N_PROPERTIES] = { NULL };
 
-G_DEFINE_TYPE_WITH_PRIVATE (PeasGtkPluginManagerStore,
-                            peas_gtk_plugin_manager_store,
-                            GTK_TYPE_LIST_STORE)
+static GtkTreeModelIface *parent_tree_model_iface = NULL;
+
+static void peas_gtk_plugin_manager_store_tree_model_init (GtkTreeModelIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (PeasGtkPluginManagerStore,
+                         peas_gtk_plugin_manager_store,
+                         GTK_TYPE_LIST_STORE,
+                         G_ADD_PRIVATE (PeasGtkPluginManagerStore)
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_MODEL,
+                                                peas_gtk_plugin_manager_store_tree_model_init))
 
 #define GET_PRIV(o) \
   (peas_gtk_plugin_manager_store_get_instance_private (o))
 
 static void
-update_plugin (PeasGtkPluginManagerStore *store,
-               GtkTreeIter               *iter,
-               PeasPluginInfo            *info)
+cached_icon_free (CachedIcon *cached)
 {
-  gboolean loaded;
-  gboolean available;
-  gboolean builtin;
-  gchar *markup;
+  g_clear_object (&cached->gicon);
+  g_free (cached->stock_id);
+  g_slice_free (CachedIcon, cached);
+}
+
+static CachedIcon *
+lookup_icon (PeasGtkPluginManagerStore *store,
+             PeasPluginInfo            *info)
+{
+  PeasGtkPluginManagerStorePrivate *priv = GET_PRIV (store);
   const gchar *icon_name;
-  const gchar *icon_stock_id = NULL;
-  GIcon *icon_gicon = NULL;
+  gchar *icon_path;
+  CachedIcon *cached;
 
-  loaded = peas_plugin_info_is_loaded (info);
-  available = peas_plugin_info_is_available (info, NULL);
-  builtin = peas_plugin_info_is_builtin (info);
+  icon_name = peas_plugin_info_get_icon_name (info);
+  icon_path = g_build_filename (peas_plugin_info_get_data_dir (info),
+                                icon_name,
+                                NULL);
 
-  if (peas_plugin_info_get_description (info) == NULL)
-    {
-      markup = g_markup_printf_escaped ("<b>%s</b>",
-                                        peas_plugin_info_get_name (info));
-    }
-  else
+  cached = g_hash_table_lookup (priv->icon_cache, icon_path);
+  if (cached != NULL)
     {
-      markup = g_markup_printf_escaped ("<b>%s</b>\n%s",
-                                        peas_plugin_info_get_name (info),
-                                        peas_plugin_info_get_description (info));
+      g_free (icon_path);
+      return cached;
     }
 
-  if (!available)
+  cached = g_slice_new0 (CachedIcon);
+
+  /* Prevent warning for the common case that icon_path
+   * does not exist but warn when it is a directory
+   */
+  if (g_file_test (icon_path, G_FILE_TEST_EXISTS))
     {
-      icon_gicon = g_themed_icon_new ("dialog-error");
+      GFile *icon_file;
+
+      icon_file = g_file_new_for_path (icon_path);
+      cached->gicon = g_file_icon_new (icon_file);
+
+      g_object_unref (icon_file);
     }
   else
     {
-      gchar *icon_path;
+      gint i;
+      GtkIconTheme *icon_theme;
+      const gchar * const *names;
+      gboolean found_icon = FALSE;
 
-      icon_name = peas_plugin_info_get_icon_name (info);
-      icon_path = g_build_filename (peas_plugin_info_get_data_dir (info),
-                                    icon_name,
-                                    NULL);
+      cached->gicon = g_themed_icon_new_with_default_fallbacks (icon_name);
 
-      /* Prevent warning for the common case that icon_path
-       * does not exist but warn when it is a directory
-       */
-      if (g_file_test (icon_path, G_FILE_TEST_EXISTS))
+      icon_theme = gtk_icon_theme_get_default ();
+      names = g_themed_icon_get_names (G_THEMED_ICON (cached->gicon));
+
+      for (i = 0; !found_icon && names[i] != NULL; ++i)
+        found_icon = gtk_icon_theme_has_icon (icon_theme, names[i]);
+
+      if (!found_icon)
         {
-          GFile *icon_file;
+          GtkStockItem stock_item;
+
+          g_clear_object (&cached->gicon);
+
+          G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+          if (gtk_stock_lookup (icon_name, &stock_item))
+            {
+              cached->stock_id = g_strdup (icon_name);
+            }
+          else
+            {
+              cached->gicon = g_themed_icon_new ("libpeas-plugin");
+            }
+          G_GNUC_END_IGNORE_DEPRECATIONS
+        }
+    }
+
+  /* Takes ownership of icon_path */
+  g_hash_table_insert (priv->icon_cache, icon_path, cached);
+  return cached;
+}
+
+/* The icon and info columns are not stored in the GtkListStore,
+ * they are computed once per PluginRow when first requested.
+ * PeasGtkPluginManagerView uses fixed height mode so
+ * only the rows which are shown request them.
+ */
+static void
+get_icon_value (PeasGtkPluginManagerStore *store,
+                PeasPluginInfo            *info,
+                PluginRow                 *row,
+                gint                       column,
+                GValue                    *value)
+{
+  PeasGtkPluginManagerStorePrivate *priv = GET_PRIV (store);
+
+  if (row->icon == NULL)
+    {
+      if (!peas_plugin_info_is_available (info, NULL))
+        row->icon = priv->error_icon;
+      else
+        row->icon = lookup_icon (store, info);
+    }
 
-          icon_file = g_file_new_for_path (icon_path);
-          icon_gicon = g_file_icon_new (icon_file);
+  if (column == PEAS_GTK_PLUGIN_MANAGER_STORE_ICON_GICON_COLUMN)
+    g_value_set_object (value, row->icon->gicon);
+  else
+    g_value_set_string (value, row->icon->stock_id);
+}
 
-          g_object_unref (icon_file);
+static void
+get_info_value (PeasPluginInfo *info,
+                PluginRow      *row,
+                GValue         *value)
+{
+  if (row->markup == NULL)
+    {
+      if (peas_plugin_info_get_description (info) == NULL)
+        {
+          row->markup = g_markup_printf_escaped ("<b>%s</b>",
+                                                 peas_plugin_info_get_name (info));
         }
       else
         {
-          gint i;
-          GtkIconTheme *icon_theme;
-          const gchar * const *names;
-          gboolean found_icon = FALSE;
+          row->markup = g_markup_printf_escaped ("<b>%s</b>\n%s",
+                                                 peas_plugin_info_get_name (info),
+                                                 peas_plugin_info_get_description (info));
+        }
+    }
 
-          icon_gicon = g_themed_icon_new_with_default_fallbacks (icon_name);
+  g_value_set_string (value, row->markup);
+}
 
-          icon_theme = gtk_icon_theme_get_default ();
-          names = g_themed_icon_get_names (G_THEMED_ICON (icon_gicon));
+static void
+peas_gtk_plugin_manager_store_get_value (GtkTreeModel *model,
+                                         GtkTreeIter  *iter,
+                                         gint          column,
+                                         GValue       *value)
+{
+  PeasGtkPluginManagerStore *store = PEAS_GTK_PLUGIN_MANAGER_STORE (model);
+  PeasGtkPluginManagerStorePrivate *priv = GET_PRIV (store);
+  PeasPluginInfo *info;
+  PluginRow *row;
 
-          for (i = 0; !found_icon && names[i] != NULL; ++i)
-            found_icon = gtk_icon_theme_has_icon (icon_theme, names[i]);
+  switch (column)
+    {
+    case PEAS_GTK_PLUGIN_MANAGER_STORE_ICON_GICON_COLUMN:
+    case PEAS_GTK_PLUGIN_MANAGER_STORE_ICON_STOCK_ID_COLUMN:
+    case PEAS_GTK_PLUGIN_MANAGER_STORE_INFO_COLUMN:
+      break;
+    default:
+      parent_tree_model_iface->get_value (model, iter, column, value);
+      return;
+    }
 
-          if (!found_icon)
-            {
-              GtkStockItem stock_item;
-
-              g_clear_object (&icon_gicon);
-
-              G_GNUC_BEGIN_IGNORE_DEPRECATIONS
-              if (gtk_stock_lookup (icon_name, &stock_item))
-                {
-                  icon_stock_id = icon_name;
-                }
-              else
-                {
-                  icon_gicon = g_themed_icon_new ("libpeas-plugin");
-                }
-              G_GNUC_END_IGNORE_DEPRECATIONS
-            }
-        }
+  g_value_init (value, ColumnTypes[column]);
 
-      g_free (icon_path);
+  info = peas_gtk_plugin_manager_store_get_plugin (store, iter);
+
+  /* Rows appended directly to the GtkListStore */
+  if (info == NULL)
+    return;
+
+  row = g_hash_table_lookup (priv->plugin_rows, info);
+  if (row == NULL)
+    return;
+
+  if (column == PEAS_GTK_PLUGIN_MANAGER_STORE_INFO_COLUMN)
+    get_info_value (info, row, value);
+  else
+    get_icon_value (store, info, row, column, value);
+}
+
+static void
+peas_gtk_plugin_manager_store_tree_model_init (GtkTreeModelIface *iface)
+{
+  parent_tree_model_iface = g_type_interface_peek_parent (iface);
+
+  iface->get_value = peas_gtk_plugin_manager_store_get_value;
+}
+
+static void
+update_plugin (PeasGtkPluginManagerStore *store,
+               GtkTreeIter               *iter,
+               PeasPluginInfo            *info)
+{
+  PeasGtkPluginManagerStorePrivate *priv = GET_PRIV (store);
+  PluginRow *row;
+  gboolean loaded;
+  gboolean available;
+  gboolean builtin;
+
+  loaded = peas_plugin_info_is_loaded (info);
+  available = peas_plugin_info_is_available (info, NULL);
+  builtin = peas_plugin_info_is_builtin (info);
+
+  /* The availability could have changed the icon */
+  row = g_hash_table_lookup (priv->plugin_rows, info);
+  if (row != NULL)
+    {
+      g_clear_pointer (&row->markup, g_free);
+      row->icon = NULL;
     }
 
+  /* Also emits GtkTreeModel::row-changed for the computed columns */
   gtk_list_store_set (GTK_LIST_STORE (store), iter,
     PEAS_GTK_PLUGIN_MANAGER_STORE_ENABLED_COLUMN,        loaded,
     PEAS_GTK_PLUGIN_MANAGER_STORE_CAN_ENABLE_COLUMN,     !builtin && available,
-    PEAS_GTK_PLUGIN_MANAGER_STORE_ICON_GICON_COLUMN,     icon_gicon,
-    PEAS_GTK_PLUGIN_MANAGER_STORE_ICON_STOCK_ID_COLUMN,  icon_stock_id,
     PEAS_GTK_PLUGIN_MANAGER_STORE_ICON_VISIBLE_COLUMN,   !available,
-    PEAS_GTK_PLUGIN_MANAGER_STORE_INFO_COLUMN,           markup,
     PEAS_GTK_PLUGIN_MANAGER_STORE_INFO_SENSITIVE_COLUMN, available && (!builtin || loaded),
     PEAS_GTK_PLUGIN_MANAGER_STORE_PLUGIN_COLUMN,         info,
     -1);
+}
+
+static void
+icon_theme_changed_cb (GtkIconTheme              *icon_theme,
+                       PeasGtkPluginManagerStore *store)
+{
+  PeasGtkPluginManagerStorePrivate *priv = GET_PRIV (store);
+  GtkTreeModel *model = GTK_TREE_MODEL (store);
+  GHashTableIter hash_iter;
+  PluginRow *row;
+  GPtrArray *paths;
+  guint i;
+
+  /* The rows only borrow the cached icons, only the rows
+   * which have looked up their icon can have been shown
+   * and need to be told to look it up again
+   */
+  paths = g_ptr_array_new_with_free_func ((GDestroyNotify) gtk_tree_path_free);
+
+  g_hash_table_iter_init (&hash_iter, priv->plugin_rows);
+  while (g_hash_table_iter_next (&hash_iter, NULL, (gpointer *) &row))
+    {
+      GtkTreePath *path;
+
+      if (row->icon == NULL)
+        continue;
 
-  g_clear_object (&icon_gicon);
-  g_free (markup);
+      row->icon = NULL;
+
+      path = gtk_tree_row_reference_get_path (row->reference);
+      if (path != NULL)
+        g_ptr_array_add (paths, path);
+    }
+
+  g_hash_table_remove_all (priv->icon_cache);
+
+  for (i = 0; i < paths->len; ++i)
+    {
+      GtkTreePath *path = g_ptr_array_index (paths, i);
+      GtkTreeIter iter;
+
+      if (gtk_tree_model_get_iter (model, &iter, path))
+        gtk_tree_model_row_changed (model, path, &iter);
+    }
+
+  g_ptr_array_unref (paths);
 }
 
 static void
@@ -177,31 +388,247 @@ plugin_loaded_toggled_cb (PeasEngine                *engine,
                           PeasPluginInfo            *info,
                           PeasGtkPluginManagerStore *store)
 {
+  PeasGtkPluginManagerStorePrivate *priv = GET_PRIV (store);
   GtkTreeIter iter;
 
+  if (priv->in_toggle_batch)
+    return;
+
   if (peas_gtk_plugin_manager_store_get_iter_from_plugin (store, &iter, info))
     update_plugin (store, &iter, info);
 }
 
+static void
+plugin_row_free (PluginRow *row)
+{
+  gtk_tree_row_reference_free (row->reference);
+  g_free (row->collate_key);
+  g_free (row->search_name);
+  g_ptr_array_unref (row->search_words);
+  g_free (row->markup);
+  g_slice_free (PluginRow, row);
+}
+
+static gchar *
+normalize_search_string (const gchar *str)
+{
+  gchar *normalized;
+  gchar *case_normalized;
+
+  normalized = g_utf8_normalize (str, -1, G_NORMALIZE_ALL);
+
+  /* Invalid UTF-8 */
+  if (normalized == NULL)
+    return g_strdup ("");
+
+  case_normalized = g_utf8_casefold (normalized, -1);
+
+  g_free (normalized);
+  return case_normalized;
+}
+
+static void
+add_search_words (GPtrArray   *words,
+                  const gchar *str)
+{
+  gchar *normalized;
+  const gchar *start = NULL;
+  const gchar *pos;
+
+  if (str == NULL)
+    return;
+
+  normalized = normalize_search_string (str);
+
+  for (pos = normalized; ; pos = g_utf8_next_char (pos))
+    {
+      gboolean is_word_char;
+
+      is_word_char = *pos != '\0' &&
+                     g_unichar_isalnum (g_utf8_get_char (pos));
+
+      if (is_word_char && start == NULL)
+        {
+          start = pos;
+        }
+      else if (!is_word_char && start != NULL)
+        {
+          g_ptr_array_add (words, g_strndup (start, pos - start));
+          start = NULL;
+        }
+
+      if (*pos == '\0')
+        break;
+    }
+
+  g_free (normalized);
+}
+
+static gint
+compare_search_words (gconstpointer a,
+                      gconstpointer b)
+{
+  return strcmp (*(const gchar **) a, *(const gchar **) b);
+}
+
+static void
+build_search_index (PluginRow      *row,
+                    PeasPluginInfo *info)
+{
+  const gchar **authors;
+  guint i;
+
+  row->search_name = normalize_search_string (peas_plugin_info_get_name (info));
+  row->search_words = g_ptr_array_new_with_free_func (g_free);
+
+  add_search_words (row->search_words, peas_plugin_info_get_name (info));
+  add_search_words (row->search_words,
+                    peas_plugin_info_get_description (info));
+  add_search_words (row->search_words,
+                    peas_plugin_info_get_module_name (info));
+
+  authors = peas_plugin_info_get_authors (info);
+  for (i = 0; authors[i] != NULL; ++i)
+    add_search_words (row->search_words, authors[i]);
+
+  /* Sorted so that a prefix can be found with a binary search */
+  g_ptr_array_sort (row->search_words, compare_search_words);
+}
+
+static gboolean
+search_words_have_prefix (GPtrArray   *words,
+                          const gchar *prefix)
+{
+  guint low = 0;
+  guint high = words->len;
+
+  /* Find the first word which is not less than the prefix */
+  while (low < high)
+    {
+      guint middle = low + (high - low) / 2;
+
+      if (strcmp (g_ptr_array_index (words, middle), prefix) < 0)
+        low = middle + 1;
+      else
+        high = middle;
+    }
+
+  return low < words->len &&
+         g_str_has_prefix (g_ptr_array_index (words, low), prefix);
+}
+
+static void
+append_plugin (PeasGtkPluginManagerStore *store,
+               PeasPluginInfo            *info)
+{
+  PeasGtkPluginManagerStorePrivate *priv = GET_PRIV (store);
+  PluginRow *row;
+  GtkTreeIter iter;
+  GtkTreePath *path;
+
+  row = g_slice_new0 (PluginRow);
+  row->collate_key = g_utf8_collate_key (peas_plugin_info_get_name (info),
+                                         -1);
+  build_search_index (row, info);
+
+  /* Must be added before the row is sorted */
+  g_hash_table_insert (priv->plugin_rows, info, row);
+
+  gtk_list_store_append (GTK_LIST_STORE (store), &iter);
+
+  path = gtk_tree_model_get_path (GTK_TREE_MODEL (store), &iter);
+  row->reference = gtk_tree_row_reference_new (GTK_TREE_MODEL (store), path);
+  gtk_tree_path_free (path);
+
+  update_plugin (store, &iter, info);
+}
+
 static gint
 model_name_sort_func (PeasGtkPluginManagerStore *store,
                       GtkTreeIter               *iter1,
                       GtkTreeIter               *iter2,
                       gpointer                   user_data)
 {
+  PeasGtkPluginManagerStorePrivate *priv = GET_PRIV (store);
   PeasPluginInfo *info1;
   PeasPluginInfo *info2;
+  PluginRow *row1;
+  PluginRow *row2;
 
   info1 = peas_gtk_plugin_manager_store_get_plugin (store, iter1);
   info2 = peas_gtk_plugin_manager_store_get_plugin (store, iter2);
 
-  return g_utf8_collate (peas_plugin_info_get_name (info1),
-                         peas_plugin_info_get_name (info2));
+  row1 = g_hash_table_lookup (priv->plugin_rows, info1);
+  row2 = g_hash_table_lookup (priv->plugin_rows, info2);
+
+  /* Rows added directly to the GtkListStore do not have one */
+  if (row1 == NULL || row2 == NULL)
+    {
+      return g_utf8_collate (peas_plugin_info_get_name (info1),
+                             peas_plugin_info_get_name (info2));
+    }
+
+  return strcmp (row1->collate_key, row2->collate_key);
+}
+
+static void
+plugin_added_cb (PeasEngine                *engine,
+                 PeasPluginInfo            *info,
+                 guint                      position,
+                 PeasGtkPluginManagerStore *store)
+{
+  PeasGtkPluginManagerStorePrivate *priv = GET_PRIV (store);
+
+  if (!peas_plugin_info_is_hidden (info) &&
+      !g_hash_table_contains (priv->plugin_rows, info))
+    append_plugin (store, info);
+}
+
+static void
+plugin_removed_cb (PeasEngine                *engine,
+                   PeasPluginInfo            *info,
+                   PeasGtkPluginManagerStore *store)
+{
+  PeasGtkPluginManagerStorePrivate *priv = GET_PRIV (store);
+  PluginRow *row;
+  GtkTreePath *path;
+  GtkTreeIter iter;
+
+  /* The engine frees the PeasPluginInfo after this signal,
+   * so its row must be removed now as a new plugin could
+   * be allocated at the same address
+   */
+  row = g_hash_table_lookup (priv->plugin_rows, info);
+  if (row == NULL)
+    return;
+
+  path = gtk_tree_row_reference_get_path (row->reference);
+
+  if (path != NULL)
+    {
+      if (gtk_tree_model_get_iter (GTK_TREE_MODEL (store), &iter, path))
+        gtk_list_store_remove (GTK_LIST_STORE (store), &iter);
+
+      gtk_tree_path_free (path);
+    }
+
+  g_hash_table_remove (priv->plugin_rows, info);
 }
 
 static void
 peas_gtk_plugin_manager_store_init (PeasGtkPluginManagerStore *store)
 {
+  PeasGtkPluginManagerStorePrivate *priv = GET_PRIV (store);
+
+  priv->icon_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                            (GDestroyNotify) cached_icon_free);
+  priv->plugin_rows = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                             NULL,
+                                             (GDestroyNotify) plugin_row_free);
+
+  priv->error_icon = g_slice_new0 (CachedIcon);
+  priv->error_icon->gicon = g_themed_icon_new ("dialog-error");
+
   gtk_list_store_set_column_types (GTK_LIST_STORE (store),
                                    PEAS_GTK_PLUGIN_MANAGER_STORE_N_COLUMNS,
                                    (GType *) ColumnTypes);
@@ -266,6 +693,16 @@ peas_gtk_plugin_manager_store_constructed (GObject *object)
 
   g_object_ref (priv->engine);
 
+  g_signal_connect_object (priv->engine,
+                           "plugin-added",
+                           G_CALLBACK (plugin_added_cb),
+                           store,
+                           0);
+  g_signal_connect_object (priv->engine,
+                           "plugin-removed",
+                           G_CALLBACK (plugin_removed_cb),
+                           store,
+                           0);
   g_signal_connect_object (priv->engine,
                            "load-plugin",
                            G_CALLBACK (plugin_loaded_toggled_cb),
@@ -276,6 +713,11 @@ peas_gtk_plugin_manager_store_constructed (GObject *object)
                            G_CALLBACK (plugin_loaded_toggled_cb),
                            store,
                            G_CONNECT_AFTER);
+  g_signal_connect_object (gtk_icon_theme_get_default (),
+                           "changed",
+                           G_CALLBACK (icon_theme_changed_cb),
+                           store,
+                           0);
 
   peas_gtk_plugin_manager_store_reload (store);
 
@@ -293,6 +735,21 @@ peas_gtk_plugin_manager_store_dispose (GObject *object)
   G_OBJECT_CLASS (peas_gtk_plugin_manager_store_parent_class)->dispose (object);
 }
 
+static void
+peas_gtk_plugin_manager_store_finalize (GObject *object)
+{
+  PeasGtkPluginManagerStore *store = PEAS_GTK_PLUGIN_MANAGER_STORE (object);
+  PeasGtkPluginManagerStorePrivate *priv = GET_PRIV (store);
+
+  g_hash_table_unref (priv->plugin_rows);
+  g_hash_table_unref (priv->icon_cache);
+  cached_icon_free (priv->error_icon);
+  g_free (priv->search_key);
+  g_free (priv->normalized_search_key);
+
+  G_OBJECT_CLASS (peas_gtk_plugin_manager_store_parent_class)->finalize (object);
+}
+
 static void
 peas_gtk_plugin_manager_store_class_init (PeasGtkPluginManagerStoreClass *klass)
 {
@@ -302,6 +759,7 @@ peas_gtk_plugin_manager_store_class_init (PeasGtkPluginManagerStoreClass *klass)
   object_class->get_property = peas_gtk_plugin_manager_store_get_property;
   object_class->constructed = peas_gtk_plugin_manager_store_constructed;
   object_class->dispose = peas_gtk_plugin_manager_store_dispose;
+  object_class->finalize = peas_gtk_plugin_manager_store_finalize;
 
   /*
    * PeasGtkPLuginManagerStore:engine:
@@ -345,36 +803,37 @@ peas_gtk_plugin_manager_store_new (PeasEngine *engine)
  * @store: A #PeasGtkPluginManagerStore.
  *
  * Reloads the list of plugins.
+ *
+ * The rows already follow the plugins added to and removed from
+ * the engine, so this only adds back the rows of the engine's
+ * plugins which are missing, i.e. removed from the #GtkListStore.
  */
 void
 peas_gtk_plugin_manager_store_reload (PeasGtkPluginManagerStore *store)
 {
   PeasGtkPluginManagerStorePrivate *priv = GET_PRIV (store);
-  GtkListStore *list_store;
   const GList *plugins;
-  GtkTreeIter iter;
 
   g_return_if_fail (PEAS_GTK_IS_PLUGIN_MANAGER_STORE (store));
 
-  list_store = GTK_LIST_STORE (store);
-
-  gtk_list_store_clear (list_store);
-
+  /* Append in the engine's order so that equal names are stable */
   plugins = peas_engine_get_plugin_list (priv->engine);
 
-  while (plugins != NULL)
+  for (; plugins != NULL; plugins = plugins->next)
     {
-      PeasPluginInfo *info;
+      PeasPluginInfo *info = plugins->data;
+      PluginRow *row;
 
-      info = PEAS_PLUGIN_INFO (plugins->data);
+      if (peas_plugin_info_is_hidden (info))
+        continue;
 
-      if (!peas_plugin_info_is_hidden (info))
-        {
-          gtk_list_store_append (list_store, &iter);
-          update_plugin (store, &iter, info);
-        }
+      row = g_hash_table_lookup (priv->plugin_rows, info);
+
+      if (row != NULL && gtk_tree_row_reference_valid (row->reference))
+        continue;
 
-      plugins = plugins->next;
+      g_hash_table_remove (priv->plugin_rows, info);
+      append_plugin (store, info);
     }
 }
 
@@ -456,8 +915,12 @@ void
 peas_gtk_plugin_manager_store_set_all_enabled (PeasGtkPluginManagerStore *store,
                                                gboolean                   enabled)
 {
+  PeasGtkPluginManagerStorePrivate *priv = GET_PRIV (store);
   GtkTreeModel *model;
   GtkTreeIter iter;
+  GHashTable *to_toggle;
+  GPtrArray *plugin_names;
+  const GList *plugins;
 
   g_return_if_fail (PEAS_GTK_IS_PLUGIN_MANAGER_STORE (store));
 
@@ -466,12 +929,61 @@ peas_gtk_plugin_manager_store_set_all_enabled (PeasGtkPluginManagerStore *store,
   if (!gtk_tree_model_get_iter_first (model, &iter))
     return;
 
+  to_toggle = g_hash_table_new (g_direct_hash, g_direct_equal);
+
   do
     {
       if (peas_gtk_plugin_manager_store_can_enable (store, &iter))
-        peas_gtk_plugin_manager_store_set_enabled (store, &iter, enabled);
+        {
+          g_hash_table_add (to_toggle,
+                            peas_gtk_plugin_manager_store_get_plugin (store,
+                                                                      &iter));
+        }
     }
   while (gtk_tree_model_iter_next (model, &iter));
+
+  /* The other plugins, like builtin
+   * and hidden ones, are left as they are
+   */
+  plugin_names = g_ptr_array_new ();
+  plugins = peas_engine_get_plugin_list (priv->engine);
+
+  for (; plugins != NULL; plugins = plugins->next)
+    {
+      PeasPluginInfo *info = plugins->data;
+      gboolean loaded;
+
+      if (g_hash_table_contains (to_toggle, info))
+        loaded = enabled;
+      else
+        loaded = peas_plugin_info_is_loaded (info);
+
+      if (loaded)
+        g_ptr_array_add (plugin_names,
+                         (gpointer) peas_plugin_info_get_module_name (info));
+    }
+
+  g_ptr_array_add (plugin_names, NULL);
+
+  /* A single engine operation, the rows are updated afterwards */
+  priv->in_toggle_batch = TRUE;
+  peas_engine_set_loaded_plugins (priv->engine,
+                                  (const gchar **) plugin_names->pdata);
+  priv->in_toggle_batch = FALSE;
+
+  if (gtk_tree_model_get_iter_first (model, &iter))
+    {
+      do
+        {
+          update_plugin (store, &iter,
+                         peas_gtk_plugin_manager_store_get_plugin (store,
+                                                                   &iter));
+        }
+      while (gtk_tree_model_iter_next (model, &iter));
+    }
+
+  g_ptr_array_unref (plugin_names);
+  g_hash_table_unref (to_toggle);
 }
 
 /*
@@ -575,25 +1087,76 @@ peas_gtk_plugin_manager_store_get_iter_from_plugin (PeasGtkPluginManagerStore *s
                                                     GtkTreeIter               *iter,
                                                     const PeasPluginInfo      *info)
 {
-  GtkTreeModel *model = GTK_TREE_MODEL (store);
-  gboolean found = FALSE;
+  PeasGtkPluginManagerStorePrivate *priv = GET_PRIV (store);
+  PluginRow *row;
+  GtkTreePath *path;
+  gboolean found;
 
   g_return_val_if_fail (PEAS_GTK_IS_PLUGIN_MANAGER_STORE (store), FALSE);
   g_return_val_if_fail (iter != NULL, FALSE);
   g_return_val_if_fail (info != NULL, FALSE);
 
-  if (gtk_tree_model_get_iter_first (model, iter))
-    {
-      PeasPluginInfo *current_info;
+  /* Hidden plugins do not have a row */
+  row = g_hash_table_lookup (priv->plugin_rows, info);
+  if (row == NULL)
+    return FALSE;
 
-      do
-        {
-          current_info = peas_gtk_plugin_manager_store_get_plugin (store, iter);
+  /* The reference is invalid if the row was
+   * removed directly from the GtkListStore
+   */
+  path = gtk_tree_row_reference_get_path (row->reference);
+  if (path == NULL)
+    return FALSE;
 
-          found = (info == current_info);
-        }
-      while (!found && gtk_tree_model_iter_next (model, iter));
-    }
+  found = gtk_tree_model_get_iter (GTK_TREE_MODEL (store), iter, path);
+  gtk_tree_path_free (path);
 
   return found;
 }
+
+/*
+ * peas_gtk_plugin_manager_store_matches_search:
+ * @store: A #PeasGtkPluginManagerStore.
+ * @iter: A #GtkTreeIter.
+ * @key: The search string.
+ *
+ * Returns if the plugin at @iter matches @key. Either the plugin's
+ * name starts with @key or a word of its name, description, authors
+ * or module name does, ignoring the case.
+ *
+ * Returns: if the plugin at @iter matches @key.
+ */
+gboolean
+peas_gtk_plugin_manager_store_matches_search (PeasGtkPluginManagerStore *store,
+                                              GtkTreeIter               *iter,
+                                              const gchar               *key)
+{
+  PeasGtkPluginManagerStorePrivate *priv = GET_PRIV (store);
+  PeasPluginInfo *info;
+  PluginRow *row;
+
+  g_return_val_if_fail (PEAS_GTK_IS_PLUGIN_MANAGER_STORE (store), FALSE);
+  g_return_val_if_fail (iter != NULL, FALSE);
+  g_return_val_if_fail (key != NULL, FALSE);
+
+  if (g_strcmp0 (priv->search_key, key) != 0)
+    {
+      g_free (priv->search_key);
+      g_free (priv->normalized_search_key);
+
+      priv->search_key = g_strdup (key);
+      priv->normalized_search_key = normalize_search_string (key);
+    }
+
+  info = peas_gtk_plugin_manager_store_get_plugin (store, iter);
+  if (info == NULL)
+    return FALSE;
+
+  row = g_hash_table_lookup (priv->plugin_rows, info);
+  if (row == NULL)
+    return FALSE;
+
+  return g_str_has_prefix (row->search_name, priv->normalized_search_key) ||
+         search_words_have_prefix (row->search_words,
+                                   priv->normalized_search_key);
+}
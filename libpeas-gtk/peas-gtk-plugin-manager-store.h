@@ -88,6 +88,10 @@ PeasPluginInfo             *peas_gtk_plugin_manager_store_get_plugin
 gboolean                    peas_gtk_plugin_manager_store_get_iter_from_plugin  (PeasGtkPluginManagerStore *store,
                                                                                  GtkTreeIter               *iter,
                                                                                  const PeasPluginInfo      *info);
+
+gboolean                    peas_gtk_plugin_manager_store_matches_search        (PeasGtkPluginManagerStore *store,
+                                                                                 GtkTreeIter               *iter,
+                                                                                 const gchar               *key);
 G_END_DECLS
 
 #endif /* __PEAS_GTK_PLUGIN_MANAGER_STORE_H__  */
@@ -26,8 +26,6 @@
 #include <config.h>
 #endif
 
-#include <string.h>
-
 #include <libpeas/peas-engine.h>
 #include <libpeas/peas-i18n.h>
 
@@ -135,16 +133,15 @@ get_dependant_plugins (PeasGtkPluginManagerView *view,
                        PeasPluginInfo           *info)
 {
   PeasGtkPluginManagerViewPrivate *priv = GET_PRIV (view);
-  const gchar *module_name;
-  const GList *plugins;
+  GList *plugins, *l;
   GList *dep_plugins = NULL;
 
-  module_name = peas_plugin_info_get_module_name (info);
-  plugins = peas_engine_get_plugin_list (priv->engine);
+  /* Includes the plugins which would be unloaded indirectly */
+  plugins = peas_engine_get_dependants (priv->engine, info);
 
-  for (; plugins != NULL; plugins = plugins->next)
+  for (l = plugins; l != NULL; l = l->next)
     {
-      PeasPluginInfo *plugin = (PeasPluginInfo *) plugins->data;
+      PeasPluginInfo *plugin = (PeasPluginInfo *) l->data;
 
       if (peas_plugin_info_is_hidden (plugin) ||
           !peas_plugin_info_is_loaded (plugin))
@@ -154,10 +151,10 @@ get_dependant_plugins (PeasGtkPluginManagerView *view,
       if (!priv->show_builtin && peas_plugin_info_is_builtin (plugin))
         continue;
 
-      if (peas_plugin_info_has_dependency (plugin, module_name))
-        dep_plugins = g_list_prepend (dep_plugins, plugin);
+      dep_plugins = g_list_prepend (dep_plugins, plugin);
     }
 
+  g_list_free (plugins);
   return dep_plugins;
 }
 
@@ -208,11 +205,16 @@ plugin_list_changed_cb (PeasEngine               *engine,
   PeasGtkPluginManagerViewPrivate *priv = GET_PRIV (view);
   PeasPluginInfo *info;
 
+  /* The store already removed the rows of removed
+   * plugins so this is never a freed PeasPluginInfo
+   */
   info = peas_gtk_plugin_manager_view_get_selected_plugin (view);
 
   peas_gtk_plugin_manager_store_reload (priv->store);
 
-  if (info != NULL)
+  /* Only rows removed directly from the store are added back */
+  if (info != NULL &&
+      peas_gtk_plugin_manager_view_get_selected_plugin (view) != info)
     peas_gtk_plugin_manager_view_set_selected_plugin (view, info);
 }
 
@@ -266,38 +268,14 @@ name_search_cb (GtkTreeModel             *model,
 {
   PeasGtkPluginManagerViewPrivate *priv = GET_PRIV (view);
   GtkTreeIter child_iter = *iter;
-  PeasPluginInfo *info;
-  gchar *normalized_string;
-  gchar *normalized_key;
-  gchar *case_normalized_string;
-  gchar *case_normalized_key;
-  gint key_len;
-  gboolean retval;
 
   convert_iter_to_child_iter (view, &child_iter);
-  info = peas_gtk_plugin_manager_store_get_plugin (priv->store, &child_iter);
-
-  if (info == NULL)
-    return FALSE;
-
-  normalized_string = g_utf8_normalize (peas_plugin_info_get_name (info), -1, G_NORMALIZE_ALL);
-  normalized_key = g_utf8_normalize (key, -1, G_NORMALIZE_ALL);
-  case_normalized_string = g_utf8_casefold (normalized_string, -1);
-  case_normalized_key = g_utf8_casefold (normalized_key, -1);
-
-  key_len = strlen (case_normalized_key);
 
   /* Oddly enough, this callback must return whether to stop the search
    * because we found a match, not whether we actually matched.
    */
-  retval = strncmp (case_normalized_key, case_normalized_string, key_len) != 0;
-
-  g_free (normalized_key);
-  g_free (normalized_string);
-  g_free (case_normalized_key);
-  g_free (case_normalized_string);
-
-  return retval;
+  return !peas_gtk_plugin_manager_store_matches_search (priv->store,
+                                                        &child_iter, key);
 }
 
 static void
@@ -516,6 +494,7 @@ peas_gtk_plugin_manager_view_init (PeasGtkPluginManagerView *view)
 {
   GtkTreeViewColumn *column;
   GtkCellRenderer *cell;
+  gint width;
 
   gtk_widget_set_has_tooltip (GTK_WIDGET (view), TRUE);
 
@@ -540,6 +519,11 @@ peas_gtk_plugin_manager_view_init (PeasGtkPluginManagerView *view)
                     G_CALLBACK (enabled_toggled_cb),
                     view);
 
+  gtk_cell_renderer_get_preferred_width (cell, GTK_WIDGET (view),
+                                         NULL, &width);
+  gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_FIXED);
+  gtk_tree_view_column_set_fixed_width (column, width);
+
   gtk_tree_view_append_column (GTK_TREE_VIEW (view), column);
 
   /* second column */
@@ -563,8 +547,15 @@ peas_gtk_plugin_manager_view_init (PeasGtkPluginManagerView *view)
                                        NULL);
 
   gtk_tree_view_column_set_spacing (column, 6);
+  gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_FIXED);
+  gtk_tree_view_column_set_expand (column, TRUE);
   gtk_tree_view_append_column (GTK_TREE_VIEW (view), column);
 
+  /* Only measure a single row, otherwise every row would compute
+   * its markup and icon as soon as the view is shown
+   */
+  gtk_tree_view_set_fixed_height_mode (GTK_TREE_VIEW (view), TRUE);
+
   /* Enable search for our non-string column */
   gtk_tree_view_set_search_column (GTK_TREE_VIEW (view),
                                    PEAS_GTK_PLUGIN_MANAGER_STORE_PLUGIN_COLUMN);
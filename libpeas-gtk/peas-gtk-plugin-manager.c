@@ -67,6 +67,12 @@ struct _PeasGtkPluginManagerPrivate {
 
   GtkWidget *about_button;
   GtkWidget *configure_button;
+
+  /* If loaded plugins are configurable, checking can enter
+   * the plugin's language runtime so it is only done once
+   * for each time the plugin is loaded
+   */
+  GHashTable *configurable_cache;
 };
 
 /* Properties */
@@ -110,12 +116,21 @@ plugin_is_configurable (PeasGtkPluginManager *pm,
                         PeasPluginInfo       *info)
 {
   PeasGtkPluginManagerPrivate *priv = peas_gtk_plugin_manager_get_instance_private (pm);
+  gpointer configurable;
 
   if (info == NULL || !peas_plugin_info_is_loaded (info))
     return FALSE;
 
-  return peas_engine_provides_extension (priv->engine, info,
-                                         PEAS_GTK_TYPE_CONFIGURABLE);
+  if (!g_hash_table_lookup_extended (priv->configurable_cache, info,
+                                     NULL, &configurable))
+    {
+      configurable =
+        GINT_TO_POINTER (peas_engine_provides_extension (priv->engine, info,
+                                                         PEAS_GTK_TYPE_CONFIGURABLE));
+      g_hash_table_insert (priv->configurable_cache, info, configurable);
+    }
+
+  return GPOINTER_TO_INT (configurable);
 }
 
 static void
@@ -287,6 +302,9 @@ plugin_loaded_toggled_cb (PeasEngine           *engine,
   PeasGtkPluginManagerView *view;
   PeasPluginInfo *selected;
 
+  /* The plugin might provide different extensions once reloaded */
+  g_hash_table_remove (priv->configurable_cache, info);
+
   view = PEAS_GTK_PLUGIN_MANAGER_VIEW (priv->view);
   selected = peas_gtk_plugin_manager_view_get_selected_plugin (view);
 
@@ -340,6 +358,8 @@ peas_gtk_plugin_manager_init (PeasGtkPluginManager *pm)
   GtkWidget *toolbar_box;
   GtkWidget *item_box;
 
+  priv->configurable_cache = g_hash_table_new (g_direct_hash, g_direct_equal);
+
   /* If we are using a PeasGtkPluginManager, we know for sure we will be using
      libpeas-gtk, so let's load the typelib for it here. */
   g_irepository_require (g_irepository_get_default (),
@@ -534,6 +554,17 @@ peas_gtk_plugin_manager_dispose (GObject *object)
   G_OBJECT_CLASS (peas_gtk_plugin_manager_parent_class)->dispose (object);
 }
 
+static void
+peas_gtk_plugin_manager_finalize (GObject *object)
+{
+  PeasGtkPluginManager *pm = PEAS_GTK_PLUGIN_MANAGER (object);
+  PeasGtkPluginManagerPrivate *priv = peas_gtk_plugin_manager_get_instance_private (pm);
+
+  g_hash_table_unref (priv->configurable_cache);
+
+  G_OBJECT_CLASS (peas_gtk_plugin_manager_parent_class)->finalize (object);
+}
+
 static void
 peas_gtk_plugin_manager_class_init (PeasGtkPluginManagerClass *klass)
 {
@@ -543,6 +574,7 @@ peas_gtk_plugin_manager_class_init (PeasGtkPluginManagerClass *klass)
   object_class->get_property = peas_gtk_plugin_manager_get_property;
   object_class->constructed = peas_gtk_plugin_manager_constructed;
   object_class->dispose = peas_gtk_plugin_manager_dispose;
+  object_class->finalize = peas_gtk_plugin_manager_finalize;
 
   /**
    * PeasGtkPluginManager:engine:
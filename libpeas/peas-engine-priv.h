@@ -22,10 +22,20 @@
 #ifndef __PEAS_ENGINE_PRIV_H__
 #define __PEAS_ENGINE_PRIV_H__
 
+#include "peas-engine.h"
+
 G_BEGIN_DECLS
 
 void peas_engine_shutdown (void);
 
+void _peas_engine_create_extensions (PeasEngine      *engine,
+                                     PeasPluginInfo **infos,
+                                     guint            n_infos,
+                                     GType            extension_type,
+                                     guint            n_parameters,
+                                     GParameter      *parameters,
+                                     PeasExtension  **extensions);
+
 G_END_DECLS
 
 #endif /* __PEAS_ENGINE_PRIV_H__ */
@@ -29,11 +29,13 @@
 
 #include "peas-i18n.h"
 #include "peas-engine.h"
+#include "peas-marshal.h"
 #include "peas-engine-priv.h"
 #include "peas-plugin-info-priv.h"
 #include "peas-plugin-loader.h"
 #include "peas-plugin-loader-c.h"
 #include "peas-object-module.h"
+#include "peas-static-plugin-priv.h"
 #include "peas-extension.h"
 #include "peas-dirs.h"
 #include "peas-debug.h"
@@ -60,12 +62,17 @@
  *
  * Since libpeas 1.22, @extension_type can be an Abstract #GType
  * and not just an Interface #GType.
+ *
+ * Since libpeas 1.22, #PeasEngine implements #GListModel, the items
+ * of which are the #PeasPluginItem for each plugin of the plugin list.
  **/
 
 /* Signals */
 enum {
   LOAD_PLUGIN,
   UNLOAD_PLUGIN,
+  PLUGIN_ADDED,
+  PLUGIN_REMOVED,
   LAST_SIGNAL
 };
 
@@ -75,6 +82,7 @@ enum {
   PROP_PLUGIN_LIST,
   PROP_LOADED_PLUGINS,
   PROP_NONGLOBAL_LOADERS,
+  PROP_WATCH_SEARCH_PATHS,
   N_PROPERTIES
 };
 
@@ -99,19 +107,54 @@ typedef struct _LoaderInfo {
 typedef struct _SearchPath {
   gchar *module_dir;
   gchar *data_dir;
+
+  /* The DirMonitors when watching the search paths */
+  GPtrArray *monitors;
 } SearchPath;
 
+typedef struct _DirMonitor {
+  PeasEngine *engine;
+  SearchPath *sp;
+
+  GFileMonitor *monitor;
+  gchar *path;
+  guint recursions;
+} DirMonitor;
+
 struct _PeasEnginePrivate {
   LoaderInfo loaders[PEAS_UTILS_N_LOADERS];
 
   GQueue search_paths;
   GQueue plugin_list;
 
+  /* The PeasPluginItems of the GListModel,
+   * only created once an item has been requested
+   */
+  GPtrArray *plugin_items;
+
+  /* The lowercased module names to a GPtrArray of
+   * the plugins which depend on them, in the order
+   * of the plugin list, the plugin might not exist yet
+   */
+  GHashTable *dependants;
+
+  /* The loaders which already garbage
+   * collected in the current unload batch
+   */
+  guint unload_batch_depth;
+  guint gc_loaders;
+
   guint in_dispose : 1;
   guint use_nonglobal_loaders : 1;
+  guint watch_search_paths : 1;
 };
 
-G_DEFINE_TYPE_WITH_PRIVATE (PeasEngine, peas_engine, G_TYPE_OBJECT)
+static void peas_engine_list_model_iface_init (GListModelInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (PeasEngine, peas_engine, G_TYPE_OBJECT,
+                         G_ADD_PRIVATE (PeasEngine)
+                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL,
+                                                peas_engine_list_model_iface_init))
 
 #define GET_PRIV(o) \
   (peas_engine_get_instance_private (o))
@@ -168,17 +211,158 @@ plugin_info_add_sorted (GQueue         *plugin_list,
   g_queue_insert_after (plugin_list, furthest_dep, info);
 }
 
-static gboolean
-load_plugin_info (PeasEngine  *engine,
-                  const gchar *filename,
-                  const gchar *module_dir,
-                  const gchar *data_dir)
+static void
+add_dependant_sorted (GPtrArray *infos,
+                      GList     *link)
+{
+  GList *item;
+  guint i;
+
+  /* A dependency can be listed more than once */
+  for (i = 0; i < infos->len; ++i)
+    {
+      if (g_ptr_array_index (infos, i) == link->data)
+        return;
+    }
+
+  /* Keep the dependants in the order of the plugin list, the plugin
+   * goes right after the closest dependant before it in the list.
+   * Adding a plugin never reorders the other plugins.
+   */
+  for (item = link->prev; item != NULL && infos->len > 0; item = item->prev)
+    {
+      for (i = infos->len; i > 0; --i)
+        {
+          if (g_ptr_array_index (infos, i - 1) == item->data)
+            {
+              g_ptr_array_insert (infos, i, link->data);
+              return;
+            }
+        }
+    }
+
+  g_ptr_array_insert (infos, 0, link->data);
+}
+
+static void
+index_dependencies (PeasEngine *engine,
+                    GList      *link,
+                    gboolean    add)
+{
+  PeasEnginePrivate *priv = GET_PRIV (engine);
+  PeasPluginInfo *info = link->data;
+  const gchar **dependencies;
+  guint i;
+
+  dependencies = peas_plugin_info_get_dependencies (info);
+
+  for (i = 0; dependencies[i] != NULL; ++i)
+    {
+      gchar *key;
+      GPtrArray *infos;
+
+      /* Like peas_plugin_info_has_dependency() */
+      key = g_ascii_strdown (dependencies[i], -1);
+      infos = g_hash_table_lookup (priv->dependants, key);
+
+      if (add)
+        {
+          if (infos == NULL)
+            {
+              infos = g_ptr_array_new ();
+              g_hash_table_insert (priv->dependants, key, infos);
+              key = NULL;
+            }
+
+          add_dependant_sorted (infos, link);
+        }
+      else if (infos != NULL)
+        {
+          g_ptr_array_remove (infos, info);
+
+          if (infos->len == 0)
+            g_hash_table_remove (priv->dependants, key);
+        }
+
+      g_free (key);
+    }
+}
+
+static GPtrArray *
+get_direct_dependants (PeasEngine  *engine,
+                       const gchar *module_name)
 {
   PeasEnginePrivate *priv = GET_PRIV (engine);
+  gchar *key;
+  GPtrArray *infos;
+
+  key = g_ascii_strdown (module_name, -1);
+  infos = g_hash_table_lookup (priv->dependants, key);
+  g_free (key);
+
+  return infos;
+}
+
+static void
+add_plugin_info (PeasEngine     *engine,
+                 PeasPluginInfo *info)
+{
+  PeasEnginePrivate *priv = GET_PRIV (engine);
+  GList *link;
+  gint position;
+
+  plugin_info_add_sorted (&priv->plugin_list, info);
+  link = g_queue_find (&priv->plugin_list, info);
+  position = g_queue_link_index (&priv->plugin_list, link);
+  index_dependencies (engine, link, TRUE);
+
+  if (priv->plugin_items != NULL)
+    {
+      g_ptr_array_insert (priv->plugin_items, position,
+                          _peas_plugin_item_new (info));
+    }
+
+  g_list_model_items_changed (G_LIST_MODEL (engine), position, 0, 1);
+  g_signal_emit (engine, signals[PLUGIN_ADDED], 0, info, (guint) position);
+  g_object_notify_by_pspec (G_OBJECT (engine),
+                            properties[PROP_PLUGIN_LIST]);
+}
+
+static void
+remove_plugin_info (PeasEngine *engine,
+                    GList      *link)
+{
+  PeasEnginePrivate *priv = GET_PRIV (engine);
+  PeasPluginInfo *info = link->data;
+  gint position;
+
+  position = g_queue_link_index (&priv->plugin_list, link);
+  index_dependencies (engine, link, FALSE);
+  g_queue_delete_link (&priv->plugin_list, link);
+
+  if (priv->plugin_items != NULL)
+    g_ptr_array_remove_index (priv->plugin_items, position);
+
+  g_list_model_items_changed (G_LIST_MODEL (engine), position, 1, 0);
+  g_signal_emit (engine, signals[PLUGIN_REMOVED], 0, info);
+  g_object_notify_by_pspec (G_OBJECT (engine),
+                            properties[PROP_PLUGIN_LIST]);
+
+  _peas_plugin_info_unref (info);
+}
+
+static gboolean
+load_plugin_info (PeasEngine       *engine,
+                  PeasPluginParser *parser,
+                  const gchar      *filename,
+                  const gchar      *module_dir,
+                  const gchar      *data_dir)
+{
   PeasPluginInfo *info;
   const gchar *module_name;
 
-  info = _peas_plugin_info_new (filename,
+  info = _peas_plugin_info_new (parser,
+                                filename,
                                 module_dir,
                                 data_dir);
 
@@ -195,18 +379,16 @@ load_plugin_info (PeasEngine  *engine,
       return FALSE;
     }
 
-  plugin_info_add_sorted (&priv->plugin_list, info);
-  g_object_notify_by_pspec (G_OBJECT (engine),
-                            properties[PROP_PLUGIN_LIST]);
-
+  add_plugin_info (engine, info);
   return TRUE;
 }
 
 static gboolean
-load_file_dir_real (PeasEngine  *engine,
-                    const gchar *module_dir,
-                    const gchar *data_dir,
-                    guint        recursions)
+load_file_dir_real (PeasEngine       *engine,
+                    PeasPluginParser *parser,
+                    const gchar      *module_dir,
+                    const gchar      *data_dir,
+                    guint             recursions)
 {
   GDir *d;
   const gchar *dirent;
@@ -232,13 +414,13 @@ load_file_dir_real (PeasEngine  *engine,
         {
           if (recursions > 0)
             {
-              found |= load_file_dir_real (engine, filename,
+              found |= load_file_dir_real (engine, parser, filename,
                                            data_dir, recursions - 1);
             }
         }
       else if (g_str_has_suffix (dirent, ".plugin"))
         {
-          found |= load_plugin_info (engine, filename,
+          found |= load_plugin_info (engine, parser, filename,
                                      module_dir, data_dir);
         }
 
@@ -251,14 +433,17 @@ load_file_dir_real (PeasEngine  *engine,
 }
 
 static gboolean
-load_resource_dir_real (PeasEngine  *engine,
-                        const gchar *module_dir,
-                        const gchar *data_dir,
-                        guint        recursions)
+load_resource_dir_real (PeasEngine       *engine,
+                        PeasPluginParser *parser,
+                        const gchar      *module_dir,
+                        const gchar      *data_dir,
+                        guint             recursions)
 {
   guint i;
+  gsize base_len;
   const gchar *module_path;
   gchar **children;
+  GString *child;
   GError *error = NULL;
   gboolean found = FALSE;
 
@@ -276,10 +461,16 @@ load_resource_dir_real (PeasEngine  *engine,
       return FALSE;
     }
 
+  /* Reuse the same buffer for the path of every child */
+  child = g_string_new (module_dir);
+  if (child->str[child->len - 1] != '/')
+    g_string_append_c (child, '/');
+
+  base_len = child->len;
+
   for (i = 0; children[i] != NULL; ++i)
     {
       gboolean is_dir;
-      gchar *child;
 
       is_dir = g_str_has_suffix (children[i], "/");
 
@@ -289,34 +480,78 @@ load_resource_dir_real (PeasEngine  *engine,
       if (!is_dir && !g_str_has_suffix (children[i], ".plugin"))
         continue;
 
-      child = g_build_path ("/", module_dir, children[i], NULL);
+      g_string_truncate (child, base_len);
+      g_string_append (child, children[i]);
 
       if (is_dir)
         {
-          found |= load_resource_dir_real (engine, child,
+          found |= load_resource_dir_real (engine, parser, child->str,
                                            data_dir, recursions - 1);
         }
       else
         {
-          found |= load_plugin_info (engine, child, module_dir, data_dir);
+          found |= load_plugin_info (engine, parser, child->str,
+                                     module_dir, data_dir);
         }
-
-      g_free (child);
     }
 
+  g_string_free (child, TRUE);
   g_strfreev (children);
 
   return found;
 }
 
 static gboolean
-load_dir_real (PeasEngine *engine,
-               SearchPath *sp)
+load_static_plugins (PeasEngine *engine)
+{
+  const PeasStaticPlugin *static_plugin;
+  PeasPluginParser *parser = NULL;
+  gboolean found = FALSE;
+
+  for (static_plugin = _peas_static_plugin_get_list ();
+       static_plugin != NULL; static_plugin = static_plugin->next)
+    {
+      PeasPluginInfo *info;
+
+      if (peas_engine_get_plugin_info (engine,
+                                       static_plugin->module_name) != NULL)
+        continue;
+
+      if (parser == NULL)
+        parser = peas_plugin_parser_new ();
+
+      info = _peas_plugin_info_new_static (parser, static_plugin);
+
+      if (info == NULL)
+        {
+          g_warning ("Error loading static plugin '%s'",
+                     static_plugin->module_name);
+          continue;
+        }
+
+      add_plugin_info (engine, info);
+      found = TRUE;
+    }
+
+  if (parser != NULL)
+    peas_plugin_parser_free (parser);
+
+  return found;
+}
+
+static gboolean
+load_dir_real (PeasEngine       *engine,
+               PeasPluginParser *parser,
+               SearchPath       *sp)
 {
   if (!g_str_has_prefix (sp->module_dir, "resource://"))
-    return load_file_dir_real (engine, sp->module_dir, sp->data_dir, 1);
+    {
+      return load_file_dir_real (engine, parser,
+                                 sp->module_dir, sp->data_dir, 1);
+    }
 
-  return load_resource_dir_real (engine, sp->module_dir, sp->data_dir, 1);
+  return load_resource_dir_real (engine, parser,
+                                 sp->module_dir, sp->data_dir, 1);
 }
 
 static void
@@ -343,6 +578,252 @@ plugin_list_changed (PeasEngine *engine)
   g_string_free (msg, TRUE);
 }
 
+static GList *
+find_plugin_info_by_filename (PeasEngine  *engine,
+                              const gchar *filename)
+{
+  PeasEnginePrivate *priv = GET_PRIV (engine);
+  GList *pos;
+
+  for (pos = priv->plugin_list.head; pos != NULL; pos = pos->next)
+    {
+      PeasPluginInfo *info = (PeasPluginInfo *) pos->data;
+
+      if (strcmp (info->filename, filename) == 0)
+        return pos;
+    }
+
+  return NULL;
+}
+
+static gboolean
+remove_plugin_infos_in_dir (PeasEngine  *engine,
+                            const gchar *dir)
+{
+  PeasEnginePrivate *priv = GET_PRIV (engine);
+  GList *pos, *next;
+  gsize dir_len = strlen (dir);
+  gboolean found = FALSE;
+
+  for (pos = priv->plugin_list.head; pos != NULL; pos = next)
+    {
+      PeasPluginInfo *info = (PeasPluginInfo *) pos->data;
+
+      next = pos->next;
+
+      if (strncmp (info->filename, dir, dir_len) != 0 ||
+          info->filename[dir_len] != G_DIR_SEPARATOR ||
+          peas_plugin_info_is_loaded (info))
+        continue;
+
+      remove_plugin_info (engine, pos);
+      found = TRUE;
+    }
+
+  return found;
+}
+
+static void watch_dir (PeasEngine  *engine,
+                       SearchPath  *sp,
+                       const gchar *path,
+                       guint        recursions);
+
+static gboolean
+dir_monitor_plugin_changed (DirMonitor  *dm,
+                            const gchar *filename)
+{
+  GList *link;
+  PeasPluginParser *parser;
+  gboolean found;
+
+  link = find_plugin_info_by_filename (dm->engine, filename);
+
+  if (link != NULL)
+    {
+      /* A loaded plugin's metadata is in use by its loader */
+      if (peas_plugin_info_is_loaded (link->data))
+        {
+          g_debug ("Not reloading '%s' as it is loaded", filename);
+          return FALSE;
+        }
+
+      remove_plugin_info (dm->engine, link);
+    }
+
+  parser = peas_plugin_parser_new ();
+  found = load_plugin_info (dm->engine, parser, filename,
+                            dm->path, dm->sp->data_dir);
+  peas_plugin_parser_free (parser);
+
+  return found || link != NULL;
+}
+
+static void
+dir_monitor_changed (GFileMonitor      *monitor,
+                     GFile             *file,
+                     GFile             *other_file,
+                     GFileMonitorEvent  event_type,
+                     DirMonitor        *dm)
+{
+  PeasEngine *engine = dm->engine;
+  gboolean found = FALSE;
+  gchar *path;
+  guint i;
+
+  path = g_file_get_path (file);
+  if (path == NULL)
+    return;
+
+  g_object_freeze_notify (G_OBJECT (engine));
+
+  switch (event_type)
+    {
+    case G_FILE_MONITOR_EVENT_CREATED:
+      /* Plugin files are only read once they have been written */
+      if (dm->recursions > 0 && g_file_test (path, G_FILE_TEST_IS_DIR))
+        {
+          PeasPluginParser *parser;
+
+          watch_dir (engine, dm->sp, path, dm->recursions - 1);
+
+          parser = peas_plugin_parser_new ();
+          found = load_file_dir_real (engine, parser, path,
+                                      dm->sp->data_dir, dm->recursions - 1);
+          peas_plugin_parser_free (parser);
+        }
+      break;
+    case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+      if (g_str_has_suffix (path, ".plugin"))
+        found = dir_monitor_plugin_changed (dm, path);
+      break;
+    case G_FILE_MONITOR_EVENT_DELETED:
+      if (g_str_has_suffix (path, ".plugin"))
+        {
+          GList *link = find_plugin_info_by_filename (engine, path);
+
+          if (link != NULL && !peas_plugin_info_is_loaded (link->data))
+            {
+              remove_plugin_info (engine, link);
+              found = TRUE;
+            }
+
+          break;
+        }
+
+      /* Could have been one of the watched directories */
+      for (i = 0; i < dm->sp->monitors->len; ++i)
+        {
+          DirMonitor *sub_dm = g_ptr_array_index (dm->sp->monitors, i);
+
+          if (sub_dm != dm && strcmp (sub_dm->path, path) == 0)
+            {
+              /* This frees sub_dm */
+              g_ptr_array_remove_index_fast (dm->sp->monitors, i);
+              found = remove_plugin_infos_in_dir (engine, path);
+              break;
+            }
+        }
+      break;
+    default:
+      break;
+    }
+
+  if (found)
+    plugin_list_changed (engine);
+
+  g_object_thaw_notify (G_OBJECT (engine));
+  g_free (path);
+}
+
+static void
+dir_monitor_free (DirMonitor *dm)
+{
+  g_signal_handlers_disconnect_by_func (dm->monitor, dir_monitor_changed, dm);
+  g_file_monitor_cancel (dm->monitor);
+  g_object_unref (dm->monitor);
+
+  g_free (dm->path);
+  g_slice_free (DirMonitor, dm);
+}
+
+static void
+watch_dir (PeasEngine  *engine,
+           SearchPath  *sp,
+           const gchar *path,
+           guint        recursions)
+{
+  GFile *file;
+  GFileMonitor *monitor;
+  DirMonitor *dm;
+  GError *error = NULL;
+
+  file = g_file_new_for_path (path);
+  monitor = g_file_monitor_directory (file, G_FILE_MONITOR_NONE,
+                                      NULL, &error);
+  g_object_unref (file);
+
+  if (monitor == NULL)
+    {
+      g_debug ("Failed to watch '%s': %s", path, error->message);
+      g_error_free (error);
+      return;
+    }
+
+  dm = g_slice_new (DirMonitor);
+  dm->engine = engine;
+  dm->sp = sp;
+  dm->monitor = monitor;
+  dm->path = g_strdup (path);
+  dm->recursions = recursions;
+
+  g_signal_connect (monitor, "changed",
+                    G_CALLBACK (dir_monitor_changed), dm);
+  g_ptr_array_add (sp->monitors, dm);
+
+  /* Like load_file_dir_real(), also watch the subdirectories */
+  if (recursions > 0)
+    {
+      GDir *d;
+      const gchar *dirent;
+
+      d = g_dir_open (path, 0, NULL);
+      if (d == NULL)
+        return;
+
+      while ((dirent = g_dir_read_name (d)))
+        {
+          gchar *filename = g_build_filename (path, dirent, NULL);
+
+          if (g_file_test (filename, G_FILE_TEST_IS_DIR))
+            watch_dir (engine, sp, filename, recursions - 1);
+
+          g_free (filename);
+        }
+
+      g_dir_close (d);
+    }
+}
+
+static void
+search_path_watch (PeasEngine *engine,
+                   SearchPath *sp)
+{
+  /* Resources cannot change */
+  if (sp->monitors != NULL ||
+      g_str_has_prefix (sp->module_dir, "resource://"))
+    return;
+
+  sp->monitors = g_ptr_array_new_with_free_func ((GDestroyNotify)
+                                                 dir_monitor_free);
+  watch_dir (engine, sp, sp->module_dir, 1);
+}
+
+static void
+search_path_unwatch (SearchPath *sp)
+{
+  g_clear_pointer (&sp->monitors, g_ptr_array_unref);
+}
+
 /**
  * peas_engine_rescan_plugins:
  * @engine: A #PeasEngine.
@@ -357,22 +838,28 @@ void
 peas_engine_rescan_plugins (PeasEngine *engine)
 {
   PeasEnginePrivate *priv = GET_PRIV (engine);
+  PeasPluginParser *parser;
   GList *item;
   gboolean found = FALSE;
 
   g_return_if_fail (PEAS_IS_ENGINE (engine));
 
+  g_object_freeze_notify (G_OBJECT (engine));
+
+  /* Static plugins registered since the last scan */
+  found = load_static_plugins (engine);
+
   if (priv->search_paths.length == 0)
-    {
-      g_debug ("No search paths where provided");
-      return;
-    }
+    g_debug ("No search paths where provided");
 
-  g_object_freeze_notify (G_OBJECT (engine));
+  /* The parser's memory is reused for every plugin file */
+  parser = peas_plugin_parser_new ();
 
   /* Go and read everything from the provided search paths */
   for (item = priv->search_paths.head; item != NULL; item = item->next)
-    found |= load_dir_real (engine, (SearchPath *) item->data);
+    found |= load_dir_real (engine, parser, (SearchPath *) item->data);
+
+  peas_plugin_parser_free (parser);
 
   if (found)
     plugin_list_changed (engine);
@@ -387,7 +874,9 @@ peas_engine_insert_search_path (PeasEngine  *engine,
                                 const gchar *data_dir)
 {
   PeasEnginePrivate *priv = GET_PRIV (engine);
+  PeasPluginParser *parser;
   SearchPath *sp;
+  gboolean found;
 
   g_return_if_fail (PEAS_IS_ENGINE (engine));
   g_return_if_fail (module_dir != NULL);
@@ -395,15 +884,24 @@ peas_engine_insert_search_path (PeasEngine  *engine,
   sp = g_slice_new (SearchPath);
   sp->module_dir = g_strdup (module_dir);
   sp->data_dir = g_strdup (data_dir ? data_dir : module_dir);
+  sp->monitors = NULL;
 
   if (prepend)
     g_queue_push_head (&priv->search_paths, sp);
   else
     g_queue_push_tail (&priv->search_paths, sp);
 
+  /* Watch before loading so that no changes are missed */
+  if (priv->watch_search_paths)
+    search_path_watch (engine, sp);
+
   g_object_freeze_notify (G_OBJECT (engine));
 
-  if (load_dir_real (engine, sp))
+  parser = peas_plugin_parser_new ();
+  found = load_dir_real (engine, parser, sp);
+  peas_plugin_parser_free (parser);
+
+  if (found)
     plugin_list_changed (engine);
 
   g_object_thaw_notify (G_OBJECT (engine));
@@ -461,6 +959,74 @@ peas_engine_prepend_search_path (PeasEngine  *engine,
   peas_engine_insert_search_path (engine, TRUE, module_dir, data_dir);
 }
 
+/**
+ * peas_engine_get_watch_search_paths:
+ * @engine: A #PeasEngine.
+ *
+ * Returns if the search paths are watched for changes.
+ *
+ * Returns: if the search paths are watched for changes.
+ *
+ * Since: 1.22
+ */
+gboolean
+peas_engine_get_watch_search_paths (PeasEngine *engine)
+{
+  PeasEnginePrivate *priv = GET_PRIV (engine);
+
+  g_return_val_if_fail (PEAS_IS_ENGINE (engine), FALSE);
+
+  return priv->watch_search_paths;
+}
+
+/**
+ * peas_engine_set_watch_search_paths:
+ * @engine: A #PeasEngine.
+ * @watch: if the search paths should be watched for changes.
+ *
+ * Sets if the search paths should be watched for changes, so that
+ * peas_engine_rescan_plugins() does not need to be called.
+ *
+ * When a plugin file is added or changed in a search path, or in one
+ * of its direct subdirectories, the plugin is added to or updated in
+ * #PeasEngine:plugin-list. When a plugin file is removed the plugin
+ * is removed from #PeasEngine:plugin-list. Loaded plugins are neither
+ * updated nor removed. Resource search paths are not watched.
+ *
+ * The changes are applied in the thread-default main context
+ * of the thread which called this function or which added the
+ * search path.
+ *
+ * Since: 1.22
+ */
+void
+peas_engine_set_watch_search_paths (PeasEngine *engine,
+                                    gboolean    watch)
+{
+  PeasEnginePrivate *priv = GET_PRIV (engine);
+  GList *item;
+
+  g_return_if_fail (PEAS_IS_ENGINE (engine));
+
+  watch = watch != FALSE;
+
+  if (priv->watch_search_paths == watch)
+    return;
+
+  priv->watch_search_paths = watch;
+
+  for (item = priv->search_paths.head; item != NULL; item = item->next)
+    {
+      if (watch)
+        search_path_watch (engine, (SearchPath *) item->data);
+      else
+        search_path_unwatch ((SearchPath *) item->data);
+    }
+
+  g_object_notify_by_pspec (G_OBJECT (engine),
+                            properties[PROP_WATCH_SEARCH_PATHS]);
+}
+
 static void
 default_engine_weak_notify (gpointer    unused,
                             PeasEngine *engine)
@@ -503,8 +1069,16 @@ peas_engine_init (PeasEngine *engine)
   g_queue_init (&priv->search_paths);
   g_queue_init (&priv->plugin_list);
 
+  priv->dependants = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                            g_free,
+                                            (GDestroyNotify) g_ptr_array_unref);
+
   /* The C plugin loader is always enabled */
   priv->loaders[PEAS_UTILS_C_LOADER_ID].enabled = TRUE;
+
+  /* Static plugins do not depend on the search paths */
+  if (load_static_plugins (engine))
+    plugin_list_changed (engine);
 }
 
 /**
@@ -551,6 +1125,10 @@ peas_engine_set_property (GObject      *object,
     case PROP_NONGLOBAL_LOADERS:
       priv->use_nonglobal_loaders = g_value_get_boolean (value);
       break;
+    case PROP_WATCH_SEARCH_PATHS:
+      peas_engine_set_watch_search_paths (engine,
+                                          g_value_get_boolean (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -579,12 +1157,37 @@ peas_engine_get_property (GObject    *object,
     case PROP_NONGLOBAL_LOADERS:
       g_value_set_boolean (value, priv->use_nonglobal_loaders);
       break;
+    case PROP_WATCH_SEARCH_PATHS:
+      g_value_set_boolean (value, priv->watch_search_paths);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
     }
 }
 
+static void
+unload_batch_begin (PeasEngine *engine)
+{
+  PeasEnginePrivate *priv = GET_PRIV (engine);
+
+  priv->unload_batch_depth++;
+}
+
+static void
+unload_batch_end (PeasEngine *engine)
+{
+  PeasEnginePrivate *priv = GET_PRIV (engine);
+
+  g_return_if_fail (priv->unload_batch_depth > 0);
+
+  if (--priv->unload_batch_depth > 0)
+    return;
+
+  /* The next batch collects again */
+  priv->gc_loaders = 0;
+}
+
 static void
 peas_engine_dispose (GObject *object)
 {
@@ -597,6 +1200,8 @@ peas_engine_dispose (GObject *object)
   priv->in_dispose = TRUE;
 
   /* First unload all the plugins */
+  unload_batch_begin (engine);
+
   for (item = priv->plugin_list.tail; item != NULL; item = item->prev)
     {
       PeasPluginInfo *info = PEAS_PLUGIN_INFO (item->data);
@@ -605,6 +1210,8 @@ peas_engine_dispose (GObject *object)
         peas_engine_unload_plugin (engine, info);
     }
 
+  unload_batch_end (engine);
+
   /* Then destroy the plugin loaders */
   for (i = 0; i < G_N_ELEMENTS (priv->loaders); ++i)
     {
@@ -636,6 +1243,7 @@ peas_engine_finalize (GObject *object)
     {
       SearchPath *sp = (SearchPath *) item->data;
 
+      search_path_unwatch (sp);
       g_free (sp->module_dir);
       g_free (sp->data_dir);
       g_slice_free (SearchPath, sp);
@@ -643,10 +1251,60 @@ peas_engine_finalize (GObject *object)
 
   g_queue_clear (&priv->search_paths);
   g_queue_clear (&priv->plugin_list);
+  g_clear_pointer (&priv->plugin_items, g_ptr_array_unref);
+  g_hash_table_unref (priv->dependants);
 
   G_OBJECT_CLASS (peas_engine_parent_class)->finalize (object);
 }
 
+static GType
+peas_engine_get_item_type (GListModel *list)
+{
+  return PEAS_TYPE_PLUGIN_ITEM;
+}
+
+static guint
+peas_engine_get_n_items (GListModel *list)
+{
+  PeasEnginePrivate *priv = GET_PRIV (PEAS_ENGINE (list));
+
+  return priv->plugin_list.length;
+}
+
+static gpointer
+peas_engine_get_item (GListModel *list,
+                      guint       position)
+{
+  PeasEnginePrivate *priv = GET_PRIV (PEAS_ENGINE (list));
+
+  if (position >= priv->plugin_list.length)
+    return NULL;
+
+  /* The items are kept in sync with the plugin list
+   * from now on so the same item is always returned
+   */
+  if (priv->plugin_items == NULL)
+    {
+      GList *item;
+
+      priv->plugin_items = g_ptr_array_new_full (priv->plugin_list.length,
+                                                 g_object_unref);
+
+      for (item = priv->plugin_list.head; item != NULL; item = item->next)
+        g_ptr_array_add (priv->plugin_items, _peas_plugin_item_new (item->data));
+    }
+
+  return g_object_ref (g_ptr_array_index (priv->plugin_items, position));
+}
+
+static void
+peas_engine_list_model_iface_init (GListModelInterface *iface)
+{
+  iface->get_item_type = peas_engine_get_item_type;
+  iface->get_n_items = peas_engine_get_n_items;
+  iface->get_item = peas_engine_get_item;
+}
+
 static void
 peas_engine_class_init (PeasEngineClass *klass)
 {
@@ -666,7 +1324,9 @@ peas_engine_class_init (PeasEngineClass *klass)
    *
    * The list of found plugins.
    *
-   * This will be modified when peas_engine_rescan_plugins() is called.
+   * This will be modified when peas_engine_rescan_plugins() is called
+   * or, if #PeasEngine:watch-search-paths is set, when the plugin files
+   * in the search paths are changed.
    *
    * Note: the list belongs to the engine and should not be modified or freed.
    */
@@ -723,6 +1383,23 @@ peas_engine_class_init (PeasEngineClass *klass)
                           G_PARAM_CONSTRUCT_ONLY |
                           G_PARAM_STATIC_STRINGS);
 
+  /**
+   * PeasEngine:watch-search-paths:
+   *
+   * If the search paths should be watched for changes.
+   *
+   * See peas_engine_set_watch_search_paths() for more information.
+   *
+   * Since: 1.22
+   */
+  properties[PROP_WATCH_SEARCH_PATHS] =
+    g_param_spec_boolean ("watch-search-paths",
+                          "Watch search paths",
+                          "Watch the search paths for changes",
+                          FALSE,
+                          G_PARAM_READWRITE |
+                          G_PARAM_STATIC_STRINGS);
+
   /**
    * PeasEngine::load-plugin:
    * @engine: A #PeasEngine.
@@ -772,6 +1449,53 @@ peas_engine_class_init (PeasEngineClass *klass)
                   1, PEAS_TYPE_PLUGIN_INFO |
                   G_SIGNAL_TYPE_STATIC_SCOPE);
 
+  /**
+   * PeasEngine::plugin-added:
+   * @engine: A #PeasEngine.
+   * @info: A #PeasPluginInfo.
+   * @position: The position of @info in the plugin list.
+   *
+   * The plugin-added signal is emitted when a plugin
+   * has been added to #PeasEngine:plugin-list.
+   *
+   * Since: 1.22
+   */
+  signals[PLUGIN_ADDED] =
+    g_signal_new (I_("plugin-added"),
+                  the_type,
+                  G_SIGNAL_RUN_LAST,
+                  0,
+                  NULL, NULL,
+                  peas_cclosure_marshal_VOID__BOXED_UINT,
+                  G_TYPE_NONE,
+                  2,
+                  PEAS_TYPE_PLUGIN_INFO |
+                  G_SIGNAL_TYPE_STATIC_SCOPE,
+                  G_TYPE_UINT);
+
+  /**
+   * PeasEngine::plugin-removed:
+   * @engine: A #PeasEngine.
+   * @info: A #PeasPluginInfo.
+   *
+   * The plugin-removed signal is emitted when a plugin has been
+   * removed from #PeasEngine:plugin-list. @info is freed after
+   * the signal has been emitted.
+   *
+   * Since: 1.22
+   */
+  signals[PLUGIN_REMOVED] =
+    g_signal_new (I_("plugin-removed"),
+                  the_type,
+                  G_SIGNAL_RUN_LAST,
+                  0,
+                  NULL, NULL,
+                  g_cclosure_marshal_VOID__BOXED,
+                  G_TYPE_NONE,
+                  1,
+                  PEAS_TYPE_PLUGIN_INFO |
+                  G_SIGNAL_TYPE_STATIC_SCOPE);
+
   g_object_class_install_properties (object_class, N_PROPERTIES, properties);
 
   /* We don't support calling PeasEngine API without module support */
@@ -1085,6 +1809,64 @@ peas_engine_get_plugin_info (PeasEngine  *engine,
   return NULL;
 }
 
+/**
+ * peas_engine_get_dependants:
+ * @engine: A #PeasEngine.
+ * @info: A #PeasPluginInfo.
+ *
+ * Gets the plugins which depend on @info, either directly
+ * or through another plugin. These are the plugins which
+ * will be unloaded when @info is unloaded if they are loaded.
+ *
+ * @info itself is never part of the list.
+ *
+ * Returns: (transfer container) (element-type Peas.PluginInfo): a #GList of
+ * #PeasPluginInfo, free it with g_list_free().
+ *
+ * Since: 1.22
+ */
+GList *
+peas_engine_get_dependants (PeasEngine     *engine,
+                            PeasPluginInfo *info)
+{
+  GHashTable *seen;
+  GQueue pending = G_QUEUE_INIT;
+  GQueue result = G_QUEUE_INIT;
+
+  g_return_val_if_fail (PEAS_IS_ENGINE (engine), NULL);
+  g_return_val_if_fail (info != NULL, NULL);
+
+  seen = g_hash_table_new (g_direct_hash, g_direct_equal);
+  g_hash_table_add (seen, info);
+  g_queue_push_tail (&pending, info);
+
+  while (!g_queue_is_empty (&pending))
+    {
+      PeasPluginInfo *dep_info = g_queue_pop_head (&pending);
+      GPtrArray *dependants;
+      guint i;
+
+      dependants = get_direct_dependants (engine,
+                                          peas_plugin_info_get_module_name (dep_info));
+      if (dependants == NULL)
+        continue;
+
+      for (i = 0; i < dependants->len; ++i)
+        {
+          PeasPluginInfo *other_info = g_ptr_array_index (dependants, i);
+
+          if (!g_hash_table_add (seen, other_info))
+            continue;
+
+          g_queue_push_tail (&pending, other_info);
+          g_queue_push_tail (&result, other_info);
+        }
+    }
+
+  g_hash_table_unref (seen);
+  return result.head;
+}
+
 static void
 peas_engine_load_plugin_real (PeasEngine     *engine,
                               PeasPluginInfo *info)
@@ -1202,8 +1984,7 @@ peas_engine_unload_plugin_real (PeasEngine     *engine,
                                 PeasPluginInfo *info)
 {
   PeasEnginePrivate *priv = GET_PRIV (engine);
-  GList *item;
-  const gchar *module_name;
+  GPtrArray *dependants;
   PeasPluginLoader *loader;
 
   if (!peas_plugin_info_is_loaded (info))
@@ -1213,27 +1994,56 @@ peas_engine_unload_plugin_real (PeasEngine     *engine,
    * dependants, to make sure we won't have an infinite loop. */
   info->loaded = FALSE;
 
-  /* First unload all the dependant plugins */
-  module_name = peas_plugin_info_get_module_name (info);
-  for (item = priv->plugin_list.tail; item != NULL; item = item->prev)
+  /* The dependant plugins are part of the same batch */
+  unload_batch_begin (engine);
+
+  /* First unload all the dependant plugins. The index keeps them in
+   * the order of the plugin list, which is sorted so that a plugin
+   * always comes after its dependencies, so they are unloaded from
+   * the last one like the plugin list is. Each of them unloads its
+   * own dependants first, so the deepest ones are unloaded first.
+   */
+  dependants = get_direct_dependants (engine,
+                                      peas_plugin_info_get_module_name (info));
+  if (dependants != NULL)
     {
-      PeasPluginInfo *other_info = PEAS_PLUGIN_INFO (item->data);
+      guint i;
 
-      if (!peas_plugin_info_is_loaded (other_info))
-        continue;
+      /* Unloading cannot add or remove plugins,
+       * but keep it alive just in case
+       */
+      g_ptr_array_ref (dependants);
+
+      for (i = dependants->len; i > 0; --i)
+        {
+          PeasPluginInfo *other_info = g_ptr_array_index (dependants, i - 1);
 
-      if (peas_plugin_info_has_dependency (other_info, module_name))
-         peas_engine_unload_plugin (engine, other_info);
+          if (peas_plugin_info_is_loaded (other_info))
+            peas_engine_unload_plugin (engine, other_info);
+        }
+
+      g_ptr_array_unref (dependants);
     }
 
-  /* find the loader and tell it to gc and unload the plugin */
+  /* find the loader and tell it to gc and unload the plugin,
+   * it only collects before the first plugin of the batch it
+   * unloads so the garbage extensions are still finalized
+   * while their plugins are loaded
+   */
   loader = get_plugin_loader (engine, info->loader_id);
 
-  peas_plugin_loader_garbage_collect (loader);
+  if ((priv->gc_loaders & (1 << info->loader_id)) == 0)
+    {
+      peas_plugin_loader_garbage_collect (loader);
+      priv->gc_loaders |= 1 << info->loader_id;
+    }
+
   peas_plugin_loader_unload (loader, info);
 
   g_debug ("Unloaded plugin '%s'", peas_plugin_info_get_module_name (info));
 
+  unload_batch_end (engine);
+
   /* Don't notify while in dispose so the
    * loaded plugins can easily be kept in GSettings
    */
@@ -1353,6 +2163,62 @@ peas_engine_create_extensionv (PeasEngine     *engine,
   return extension;
 }
 
+/* Creates the extensions of several loaded plugins
+ * which provide @extension_type. Consecutive plugins
+ * using the same loader are handed to it in one call,
+ * so the extensions are always constructed in the order
+ * of @infos, which is the order of the plugin list.
+ */
+void
+_peas_engine_create_extensions (PeasEngine      *engine,
+                                PeasPluginInfo **infos,
+                                guint            n_infos,
+                                GType            extension_type,
+                                guint            n_parameters,
+                                GParameter      *parameters,
+                                PeasExtension  **extensions)
+{
+  guint start, end;
+  guint i;
+
+  g_return_if_fail (PEAS_IS_ENGINE (engine));
+  g_return_if_fail (G_TYPE_IS_INTERFACE (extension_type) ||
+                    G_TYPE_IS_ABSTRACT (extension_type));
+
+  for (start = 0; start < n_infos; start = end)
+    {
+      gint loader_id = infos[start]->loader_id;
+
+      g_warn_if_fail (peas_plugin_info_is_loaded (infos[start]));
+
+      for (end = start + 1; end < n_infos; ++end)
+        {
+          if (infos[end]->loader_id != loader_id)
+            break;
+
+          g_warn_if_fail (peas_plugin_info_is_loaded (infos[end]));
+        }
+
+      peas_plugin_loader_create_extensions (get_plugin_loader (engine,
+                                                               loader_id),
+                                            infos + start, end - start,
+                                            extension_type,
+                                            n_parameters, parameters,
+                                            extensions + start);
+    }
+
+  for (i = 0; i < n_infos; ++i)
+    {
+      if (!G_TYPE_CHECK_INSTANCE_TYPE (extensions[i], extension_type))
+        {
+          g_warning ("Plugin '%s' does not provide a '%s' extension",
+                     peas_plugin_info_get_module_name (infos[i]),
+                     g_type_name (extension_type));
+          g_clear_object (&extensions[i]);
+        }
+    }
+}
+
 /**
  * peas_engine_create_extension_valist: (skip)
  * @engine: A #PeasEngine.
@@ -1539,6 +2405,10 @@ peas_engine_set_loaded_plugins (PeasEngine   *engine,
 
   g_return_if_fail (PEAS_IS_ENGINE (engine));
 
+  /* Only notify PeasEngine:loaded-plugins once */
+  g_object_freeze_notify (G_OBJECT (engine));
+  unload_batch_begin (engine);
+
   for (pl = priv->plugin_list.head; pl != NULL; pl = pl->next)
     {
       PeasPluginInfo *info = (PeasPluginInfo *) pl->data;
@@ -1559,6 +2429,9 @@ peas_engine_set_loaded_plugins (PeasEngine   *engine,
       else if (is_loaded && !to_load)
         g_signal_emit (engine, signals[UNLOAD_PLUGIN], 0, info);
     }
+
+  unload_batch_end (engine);
+  g_object_thaw_notify (G_OBJECT (engine));
 }
 
 /**
@@ -85,6 +85,11 @@ void              peas_engine_add_search_path     (PeasEngine      *engine,
 void              peas_engine_prepend_search_path (PeasEngine      *engine,
                                                    const gchar     *module_dir,
                                                    const gchar     *data_dir);
+gboolean          peas_engine_get_watch_search_paths
+                                                  (PeasEngine      *engine);
+void              peas_engine_set_watch_search_paths
+                                                  (PeasEngine      *engine,
+                                                   gboolean         watch);
 
 /* plugin management */
 void              peas_engine_enable_loader       (PeasEngine      *engine,
@@ -96,6 +101,8 @@ void              peas_engine_set_loaded_plugins  (PeasEngine      *engine,
                                                    const gchar    **plugin_names);
 PeasPluginInfo   *peas_engine_get_plugin_info     (PeasEngine      *engine,
                                                    const gchar     *plugin_name);
+GList            *peas_engine_get_dependants      (PeasEngine      *engine,
+                                                   PeasPluginInfo  *info);
 
 /* plugin loading and unloading */
 gboolean          peas_engine_load_plugin         (PeasEngine      *engine,
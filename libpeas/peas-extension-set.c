@@ -27,6 +27,7 @@
 
 #include "peas-extension-set.h"
 
+#include "peas-engine-priv.h"
 #include "peas-i18n.h"
 #include "peas-introspection.h"
 #include "peas-plugin-info.h"
@@ -199,19 +200,47 @@ peas_extension_set_get_property (GObject    *object,
 }
 
 static void
-add_extension (PeasExtensionSet *set,
-               PeasPluginInfo   *info)
+add_extension_item (PeasExtensionSet *set,
+                    PeasPluginInfo   *info,
+                    PeasExtension    *exten)
 {
   PeasExtensionSetPrivate *priv = GET_PRIV (set);
-  PeasExtension *exten;
   ExtensionItem *item;
 
+  /* The plugin did not provide a usable extension */
+  if (exten == NULL)
+    return;
+
+  item = g_slice_new (ExtensionItem);
+  item->info = info;
+  item->exten = exten;
+
+  g_queue_push_tail (&priv->extensions, item);
+  g_signal_emit (set, signals[EXTENSION_ADDED], 0, info, exten);
+}
+
+static gboolean
+plugin_provides_extension (PeasExtensionSet *set,
+                           PeasPluginInfo   *info)
+{
+  PeasExtensionSetPrivate *priv = GET_PRIV (set);
+
   /* Let's just ignore unloaded plugins... */
   if (!peas_plugin_info_is_loaded (info))
-    return;
+    return FALSE;
+
+  return peas_engine_provides_extension (priv->engine, info,
+                                         priv->exten_type);
+}
 
-  if (!peas_engine_provides_extension (priv->engine, info,
-                                       priv->exten_type))
+static void
+add_extension (PeasExtensionSet *set,
+               PeasPluginInfo   *info)
+{
+  PeasExtensionSetPrivate *priv = GET_PRIV (set);
+  PeasExtension *exten;
+
+  if (!plugin_provides_extension (set, info))
     return;
 
   exten = peas_engine_create_extensionv (priv->engine, info,
@@ -219,12 +248,7 @@ add_extension (PeasExtensionSet *set,
                                          priv->n_parameters,
                                          priv->parameters);
 
-  item = g_slice_new (ExtensionItem);
-  item->info = info;
-  item->exten = exten;
-
-  g_queue_push_tail (&priv->extensions, item);
-  g_signal_emit (set, signals[EXTENSION_ADDED], 0, info, exten);
+  add_extension_item (set, info, exten);
 }
 
 static void
@@ -272,15 +296,40 @@ peas_extension_set_constructed (GObject *object)
   PeasExtensionSet *set = PEAS_EXTENSION_SET (object);
   PeasExtensionSetPrivate *priv = GET_PRIV (set);
   GList *plugins, *l;
+  GPtrArray *infos;
+  PeasExtension **extensions;
+  guint i;
 
   if (priv->engine == NULL)
     priv->engine = peas_engine_get_default ();
 
   g_object_ref (priv->engine);
 
+  infos = g_ptr_array_new ();
+
   plugins = (GList *) peas_engine_get_plugin_list (priv->engine);
   for (l = plugins; l; l = l->next)
-    add_extension (set, (PeasPluginInfo *) l->data);
+    {
+      if (plugin_provides_extension (set, (PeasPluginInfo *) l->data))
+        g_ptr_array_add (infos, l->data);
+    }
+
+  /* Create all of the extensions at once so that each loader
+   * can amortize the cost across its plugins, they are still
+   * constructed and added in the order of the plugin list
+   */
+  extensions = g_new0 (PeasExtension *, infos->len);
+  _peas_engine_create_extensions (priv->engine,
+                                  (PeasPluginInfo **) infos->pdata,
+                                  infos->len, priv->exten_type,
+                                  priv->n_parameters, priv->parameters,
+                                  extensions);
+
+  for (i = 0; i < infos->len; ++i)
+    add_extension_item (set, g_ptr_array_index (infos, i), extensions[i]);
+
+  g_free (extensions);
+  g_ptr_array_unref (infos);
 
   g_signal_connect_object (priv->engine, "load-plugin",
                            G_CALLBACK (add_extension), set,
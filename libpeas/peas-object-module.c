@@ -31,6 +31,7 @@
 
 #include "peas-object-module.h"
 #include "peas-plugin-loader.h"
+#include "peas-static-plugin-priv.h"
 
 /**
  * SECTION:peas-object-module
@@ -72,6 +73,9 @@ struct _PeasObjectModulePrivate {
   PeasObjectModuleRegisterFunc register_func;
   GArray *implementations;
 
+  /* Set for static plugins, which do not have a library */
+  PeasObjectModuleRegisterFunc static_register_func;
+
   gchar *path;
   gchar *module_name;
   gchar *symbol;
@@ -99,6 +103,13 @@ peas_object_module_load (GTypeModule *gmodule)
 
   g_return_val_if_fail (priv->module_name != NULL, FALSE);
 
+  if (priv->static_register_func != NULL)
+    {
+      priv->register_func = priv->static_register_func;
+      priv->register_func (module);
+      return TRUE;
+    }
+
   if (priv->path == NULL)
     {
       g_return_val_if_fail (priv->resident, FALSE);
@@ -177,7 +188,8 @@ peas_object_module_unload (GTypeModule *gmodule)
   ExtensionImplementation *impls;
   guint i;
 
-  g_module_close (priv->library);
+  if (priv->library != NULL)
+    g_module_close (priv->library);
 
   priv->library = NULL;
   priv->register_func = NULL;
@@ -433,6 +445,26 @@ peas_object_module_new_embedded (const gchar *module_name,
                                            NULL));
 }
 
+PeasObjectModule *
+_peas_object_module_new_static (const gchar                  *module_name,
+                                PeasStaticPluginRegisterFunc  register_func)
+{
+  PeasObjectModule *module;
+
+  g_return_val_if_fail (module_name != NULL && *module_name != '\0', NULL);
+  g_return_val_if_fail (register_func != NULL, NULL);
+
+  module = PEAS_OBJECT_MODULE (g_object_new (PEAS_TYPE_OBJECT_MODULE,
+                                             "module-name", module_name,
+                                             "resident", TRUE,
+                                             "local-linkage", FALSE,
+                                             NULL));
+
+  GET_PRIV (module)->static_register_func = register_func;
+
+  return module;
+}
+
 /**
  * peas_object_module_create_object: (skip)
  * @module: A #PeasObjectModule.
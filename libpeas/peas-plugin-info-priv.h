@@ -24,7 +24,13 @@
 #define __PEAS_PLUGIN_INFO_PRIV_H__
 
 #include "peas-plugin-info.h"
+#include "peas-plugin-item.h"
+#include "peas-plugin-parser.h"
+#include "peas-static-plugin.h"
 
+/* The strings are allocated together with the
+ * PeasPluginInfo and are freed when it is freed
+ */
 struct _PeasPluginInfo {
   /*< private >*/
   gint refcount;
@@ -38,6 +44,7 @@ struct _PeasPluginInfo {
 
   gint loader_id;
   gchar *embedded;
+  const PeasStaticPlugin *static_plugin;
   gchar *module_name;
   gchar **dependencies;
 
@@ -50,7 +57,8 @@ struct _PeasPluginInfo {
   gchar *version;
   gchar *help_uri;
 
-  GHashTable *external_data;
+  /* Key and value pairs of the X- keys */
+  gchar **external_data;
 
   GSettingsSchemaSource *schema_source;
 
@@ -66,11 +74,17 @@ struct _PeasPluginInfo {
   guint hidden : 1;
 };
 
-PeasPluginInfo *_peas_plugin_info_new   (const gchar    *filename,
-                                         const gchar    *module_dir,
-                                         const gchar    *data_dir);
-PeasPluginInfo *_peas_plugin_info_ref   (PeasPluginInfo *info);
-void            _peas_plugin_info_unref (PeasPluginInfo *info);
+PeasPluginInfo *_peas_plugin_info_new   (PeasPluginParser *parser,
+                                         const gchar      *filename,
+                                         const gchar      *module_dir,
+                                         const gchar      *data_dir);
+PeasPluginInfo *_peas_plugin_info_new_static
+                                        (PeasPluginParser       *parser,
+                                         const PeasStaticPlugin *static_plugin);
+PeasPluginInfo *_peas_plugin_info_ref   (PeasPluginInfo   *info);
+void            _peas_plugin_info_unref (PeasPluginInfo   *info);
+
+PeasPluginItem *_peas_plugin_item_new   (PeasPluginInfo   *info);
 
 
 #endif /* __PEAS_PLUGIN_INFO_PRIV_H__ */
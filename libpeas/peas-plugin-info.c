@@ -26,6 +26,7 @@
 
 #include <string.h>
 #include <glib.h>
+#include <glib/gstdio.h>
 
 #include "peas-i18n.h"
 #include "peas-plugin-info-priv.h"
@@ -63,6 +64,26 @@
  * ]|
  **/
 
+/* Plugins in the same module directory share their
+ * GSettingsSchemaSource, it is only kept while in use
+ */
+typedef struct {
+  GSettingsSchemaSource *source;
+  guint n_users;
+
+  /* Used to notice that gschemas.compiled was recompiled,
+   * i.e. when a plugin with a new schema was installed
+   */
+  gint64 mtime;
+  guint64 inode;
+  gint64 size;
+} SharedSchemaSource;
+
+static GHashTable *shared_schema_sources = NULL;
+static GMutex shared_schema_sources_lock;
+
+static void release_schema_source (PeasPluginInfo *info);
+
 G_DEFINE_QUARK (peas-plugin-info-error, peas_plugin_info_error)
 
 G_DEFINE_BOXED_TYPE (PeasPluginInfo, peas_plugin_info,
@@ -82,257 +103,475 @@ _peas_plugin_info_unref (PeasPluginInfo *info)
   if (!g_atomic_int_dec_and_test (&info->refcount))
     return;
 
-  g_free (info->filename);
-  g_free (info->module_dir);
-  g_free (info->data_dir);
-  g_free (info->embedded);
-  g_free (info->module_name);
-  g_strfreev (info->dependencies);
-  g_free (info->name);
-  g_free (info->desc);
-  g_free (info->icon_name);
-  g_free (info->website);
-  g_free (info->copyright);
-  g_free (info->version);
-  g_free (info->help_uri);
-  g_strfreev (info->authors);
-
   if (info->schema_source != NULL)
-    g_settings_schema_source_unref (info->schema_source);
-
-  if (info->external_data != NULL)
-    g_hash_table_unref (info->external_data);
+    release_schema_source (info);
 
   if (info->error != NULL)
     g_error_free (info->error);
 
+  /* The strings are part of the same allocation */
   g_free (info);
 }
 
-/*
- * _peas_plugin_info_new:
- * @filename: The filename where to read the plugin information.
- * @module_dir: The module directory.
- * @data_dir: The data directory.
- *
- * Creates a new #PeasPluginInfo from a file on the disk.
- *
- * Return value: a newly created #PeasPluginInfo.
- */
-PeasPluginInfo *
-_peas_plugin_info_new (const gchar *filename,
-                       const gchar *module_dir,
-                       const gchar *data_dir)
+static const gsize string_fields[] = {
+  G_STRUCT_OFFSET (PeasPluginInfo, filename),
+  G_STRUCT_OFFSET (PeasPluginInfo, module_dir),
+  G_STRUCT_OFFSET (PeasPluginInfo, data_dir),
+  G_STRUCT_OFFSET (PeasPluginInfo, embedded),
+  G_STRUCT_OFFSET (PeasPluginInfo, module_name),
+  G_STRUCT_OFFSET (PeasPluginInfo, name),
+  G_STRUCT_OFFSET (PeasPluginInfo, desc),
+  G_STRUCT_OFFSET (PeasPluginInfo, icon_name),
+  G_STRUCT_OFFSET (PeasPluginInfo, copyright),
+  G_STRUCT_OFFSET (PeasPluginInfo, website),
+  G_STRUCT_OFFSET (PeasPluginInfo, version),
+  G_STRUCT_OFFSET (PeasPluginInfo, help_uri)
+};
+
+static const gsize strv_fields[] = {
+  G_STRUCT_OFFSET (PeasPluginInfo, dependencies),
+  G_STRUCT_OFFSET (PeasPluginInfo, authors),
+  G_STRUCT_OFFSET (PeasPluginInfo, external_data)
+};
+
+/* Copies @tmp_info and all of its strings into a single allocation */
+static PeasPluginInfo *
+plugin_info_pack (const PeasPluginInfo *tmp_info)
 {
-  gsize i;
-  gboolean is_resource;
-  gchar *loader = NULL;
-  gchar **strv, **keys;
   PeasPluginInfo *info;
-  GKeyFile *plugin_file;
-  GBytes *bytes = NULL;
-  GError *error = NULL;
+  gsize i, j, size;
+  gchar **vectors;
+  gchar *strings;
 
-  g_return_val_if_fail (filename != NULL, NULL);
+  size = sizeof (PeasPluginInfo);
 
-  is_resource = g_str_has_prefix (filename, "resource://");
+  /* A missing list is packed as an empty list */
+  for (i = 0; i < G_N_ELEMENTS (strv_fields); ++i)
+    {
+      gchar **strv = G_STRUCT_MEMBER (gchar **, tmp_info, strv_fields[i]);
 
-  info = g_new0 (PeasPluginInfo, 1);
-  info->refcount = 1;
+      for (j = 0; strv != NULL && strv[j] != NULL; ++j)
+        size += sizeof (gchar *) + strlen (strv[j]) + 1;
 
-  plugin_file = g_key_file_new ();
-  
-  if (is_resource)
+      size += sizeof (gchar *);
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (string_fields); ++i)
     {
-      bytes = g_resources_lookup_data (filename + strlen ("resource://"),
-                                       G_RESOURCE_LOOKUP_FLAGS_NONE,
-                                       &error);
+      gchar *str = G_STRUCT_MEMBER (gchar *, tmp_info, string_fields[i]);
+
+      if (str != NULL)
+        size += strlen (str) + 1;
     }
-  else
+
+  info = g_malloc (size);
+  *info = *tmp_info;
+
+  /* The vectors come first as they must be aligned */
+  vectors = (gchar **) (info + 1);
+  strings = (gchar *) vectors;
+
+  for (i = 0; i < G_N_ELEMENTS (strv_fields); ++i)
     {
-      gchar *content;
-      gsize length;
+      gchar **strv = G_STRUCT_MEMBER (gchar **, tmp_info, strv_fields[i]);
 
-      if (g_file_get_contents (filename, &content, &length, &error))
-        bytes = g_bytes_new_take (content, length);
+      strings += sizeof (gchar *);
+
+      if (strv != NULL)
+        strings += g_strv_length (strv) * sizeof (gchar *);
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (strv_fields); ++i)
+    {
+      gchar **strv = G_STRUCT_MEMBER (gchar **, tmp_info, strv_fields[i]);
+
+      G_STRUCT_MEMBER (gchar **, info, strv_fields[i]) = vectors;
+
+      for (j = 0; strv != NULL && strv[j] != NULL; ++j)
+        {
+          *vectors++ = strings;
+          strings = g_stpcpy (strings, strv[j]) + 1;
+        }
+
+      *vectors++ = NULL;
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (string_fields); ++i)
+    {
+      gchar *str = G_STRUCT_MEMBER (gchar *, tmp_info, string_fields[i]);
+
+      if (str == NULL)
+        continue;
+
+      G_STRUCT_MEMBER (gchar *, info, string_fields[i]) = strings;
+      strings = g_stpcpy (strings, str) + 1;
+    }
+
+  g_assert (strings == (gchar *) info + size);
+
+  return info;
+}
+
+static gchar *
+join_string_list (PeasPluginParser  *parser,
+                  gchar            **strv)
+{
+  gsize i, len = 0;
+  gchar *str, *pos;
+
+  for (i = 0; strv[i] != NULL; ++i)
+    len += strlen (strv[i]) + 1;
+
+  if (len == 0)
+    return (gchar *) "";
+
+  pos = str = peas_plugin_parser_alloc (parser, len);
+
+  for (i = 0; strv[i] != NULL; ++i)
+    {
+      if (i != 0)
+        *pos++ = '\n';
+
+      pos = g_stpcpy (pos, strv[i]);
     }
 
-  if (bytes == NULL ||
-      !g_key_file_load_from_data (plugin_file,
-                                  g_bytes_get_data (bytes, NULL),
-                                  g_bytes_get_size (bytes),
-                                  G_KEY_FILE_NONE, &error))
+  return str;
+}
+
+static gchar *
+build_data_dir (PeasPluginParser *parser,
+                const gchar      *data_dir,
+                const gchar      *module_name,
+                gchar             separator)
+{
+  gsize data_dir_len, module_name_len;
+  gboolean add_separator;
+  gchar *str;
+
+  /* Like g_build_path() but in the arena as it is only temporary,
+   * a data_dir of only separators is the root and keeps one of them
+   */
+  data_dir_len = strlen (data_dir);
+  add_separator = data_dir_len > 0;
+  while (data_dir_len > 0 && data_dir[data_dir_len - 1] == separator)
+    data_dir_len--;
+
+  while (*module_name == separator)
+    module_name++;
+
+  module_name_len = strlen (module_name);
+
+  str = peas_plugin_parser_alloc (parser,
+                                  data_dir_len + module_name_len + 2);
+  memcpy (str, data_dir, data_dir_len);
+
+  if (add_separator)
+    str[data_dir_len++] = separator;
+
+  memcpy (str + data_dir_len, module_name, module_name_len + 1);
+
+  return str;
+}
+
+static PeasPluginInfo *
+plugin_info_new (PeasPluginParser       *parser,
+                 const gchar            *filename,
+                 const gchar            *data,
+                 gsize                   length,
+                 const gchar            *module_dir,
+                 const gchar            *data_dir,
+                 const PeasStaticPlugin *static_plugin)
+{
+  gsize i, n_external_data = 0;
+  gboolean is_resource;
+  const gchar *loader;
+  gchar **strv, **keys;
+  PeasPluginInfo tmp_info = { 0 };
+  GError *error = NULL;
+
+  if (!peas_plugin_parser_parse (parser, data, length, "Plugin", &error))
     {
       g_warning ("Bad plugin file '%s': %s", filename, error->message);
       g_error_free (error);
-      goto error;
+      return NULL;
     }
 
+  is_resource = g_str_has_prefix (filename, "resource://");
+
   /* Get module name */
-  info->module_name = g_key_file_get_string (plugin_file, "Plugin",
-                                             "Module", NULL);
-  if (info->module_name == NULL || *info->module_name == '\0')
+  if (static_plugin != NULL)
+    {
+      tmp_info.module_name = (gchar *) static_plugin->module_name;
+    }
+  else
+    {
+      tmp_info.module_name = (gchar *) peas_plugin_parser_get_string (parser,
+                                                                      "Module");
+    }
+
+  if (tmp_info.module_name == NULL || *tmp_info.module_name == '\0')
     {
       g_warning ("Could not find 'Module' in '[Plugin]' section in '%s'",
                  filename);
-      goto error;
+      return NULL;
     }
 
   /* Get Name */
-  info->name = g_key_file_get_locale_string (plugin_file, "Plugin",
-                                      "Name", NULL, NULL);
-  if (info->name == NULL || *info->name == '\0')
+  tmp_info.name = (gchar *) peas_plugin_parser_get_locale_string (parser,
+                                                                  "Name");
+  if (tmp_info.name == NULL || *tmp_info.name == '\0')
     {
       g_warning ("Could not find 'Name' in '[Plugin]' section in '%s'",
                  filename);
-      goto error;
+      return NULL;
     }
 
   /* Get the loader for this plugin */
-  loader = g_key_file_get_string (plugin_file, "Plugin", "Loader", NULL);
+  loader = peas_plugin_parser_get_string (parser, "Loader");
   if (loader == NULL || *loader == '\0')
     {
       /* Default to the C loader */
-      info->loader_id = PEAS_UTILS_C_LOADER_ID;
+      tmp_info.loader_id = PEAS_UTILS_C_LOADER_ID;
     }
   else
     {
-      info->loader_id = peas_utils_get_loader_id (loader);
+      tmp_info.loader_id = peas_utils_get_loader_id (loader);
 
-      if (info->loader_id == -1)
+      if (tmp_info.loader_id == -1)
         {
           g_warning ("Unkown 'Loader' in '[Plugin]' section in '%s': %s",
                      filename, loader);
-          goto error;
+          return NULL;
         }
     }
 
   /* Get Embedded */
-  info->embedded = g_key_file_get_string (plugin_file, "Plugin",
-                                          "Embedded", NULL);
-  if (info->embedded != NULL)
+  tmp_info.embedded = (gchar *) peas_plugin_parser_get_string (parser,
+                                                               "Embedded");
+  if (static_plugin != NULL)
     {
-      if (info->loader_id != PEAS_UTILS_C_LOADER_ID)
+      if (tmp_info.loader_id != PEAS_UTILS_C_LOADER_ID)
+        {
+          g_warning ("Bad plugin file '%s': static plugins "
+                     "must use the C plugin loader", filename);
+          return NULL;
+        }
+
+      if (tmp_info.embedded != NULL)
+        {
+          g_warning ("Bad plugin file '%s': static plugins "
+                     "cannot be embedded", filename);
+          return NULL;
+        }
+    }
+  else if (tmp_info.embedded != NULL)
+    {
+      if (tmp_info.loader_id != PEAS_UTILS_C_LOADER_ID)
         {
           g_warning ("Bad plugin file '%s': embedded plugins "
                      "must use the C plugin loader", filename);
-          goto error;
+          return NULL;
         }
 
       if (!is_resource)
         {
           g_warning ("Bad plugin file '%s': embedded plugins "
                      "must be a resource", filename);
-          goto error;
+          return NULL;
         }
     }
   else if (is_resource)
     {
       g_warning ("Bad plugin file '%s': resource plugins must be embedded",
                  filename);
-      goto error;
+      return NULL;
     }
 
   /* Get the dependency list */
-  info->dependencies = g_key_file_get_string_list (plugin_file,
-                                                   "Plugin",
-                                                   "Depends", NULL, NULL);
-  if (info->dependencies == NULL)
-    info->dependencies = g_new0 (gchar *, 1);
+  tmp_info.dependencies = peas_plugin_parser_get_string_list (parser,
+                                                              "Depends");
 
   /* Get Description */
-  info->desc = g_key_file_get_locale_string (plugin_file, "Plugin",
-                                             "Description", NULL, NULL);
+  tmp_info.desc = (gchar *) peas_plugin_parser_get_locale_string (parser,
+                                                                  "Description");
 
   /* Get Icon */
-  info->icon_name = g_key_file_get_locale_string (plugin_file, "Plugin",
-                                                  "Icon", NULL, NULL);
+  tmp_info.icon_name = (gchar *) peas_plugin_parser_get_locale_string (parser,
+                                                                       "Icon");
 
   /* Get Authors */
-  info->authors = g_key_file_get_string_list (plugin_file, "Plugin",
-                                              "Authors", NULL, NULL);
-  if (info->authors == NULL)
-    info->authors = g_new0 (gchar *, 1);
+  tmp_info.authors = peas_plugin_parser_get_string_list (parser, "Authors");
 
   /* Get Copyright */
-  strv = g_key_file_get_string_list (plugin_file, "Plugin",
-                                     "Copyright", NULL, NULL);
+  strv = peas_plugin_parser_get_string_list (parser, "Copyright");
   if (strv != NULL)
-    {
-      info->copyright = g_strjoinv ("\n", strv);
-
-      g_strfreev (strv);
-    }
+    tmp_info.copyright = join_string_list (parser, strv);
 
   /* Get Website */
-  info->website = g_key_file_get_string (plugin_file, "Plugin",
-                                         "Website", NULL);
+  tmp_info.website = (gchar *) peas_plugin_parser_get_string (parser,
+                                                              "Website");
 
   /* Get Version */
-  info->version = g_key_file_get_string (plugin_file, "Plugin",
-                                         "Version", NULL);
+  tmp_info.version = (gchar *) peas_plugin_parser_get_string (parser,
+                                                              "Version");
 
   /* Get Help URI */
-  info->help_uri = g_key_file_get_string (plugin_file, "Plugin",
-                                          OS_HELP_KEY, NULL);
-  if (info->help_uri == NULL)
-    info->help_uri = g_key_file_get_string (plugin_file, "Plugin",
-                                            "Help", NULL);
+  tmp_info.help_uri = (gchar *) peas_plugin_parser_get_string (parser,
+                                                               OS_HELP_KEY);
+  if (tmp_info.help_uri == NULL)
+    tmp_info.help_uri = (gchar *) peas_plugin_parser_get_string (parser,
+                                                                 "Help");
 
   /* Get Builtin */
-  info->builtin = g_key_file_get_boolean (plugin_file, "Plugin",
-                                          "Builtin", NULL);
+  tmp_info.builtin = peas_plugin_parser_get_boolean (parser, "Builtin");
 
   /* Get Hidden */
-  info->hidden = g_key_file_get_boolean (plugin_file, "Plugin",
-                                         "Hidden", NULL);
+  tmp_info.hidden = peas_plugin_parser_get_boolean (parser, "Hidden");
 
-  keys = g_key_file_get_keys (plugin_file, "Plugin", NULL, NULL);
+  keys = peas_plugin_parser_get_keys (parser);
 
   for (i = 0; keys[i] != NULL; ++i)
     {
-      if (!g_str_has_prefix (keys[i], "X-"))
-        continue;
+      if (g_str_has_prefix (keys[i], "X-"))
+        n_external_data++;
+    }
 
-      if (info->external_data == NULL)
-        info->external_data = g_hash_table_new_full (g_str_hash, g_str_equal,
-                                                     (GDestroyNotify) g_free,
-                                                     (GDestroyNotify) g_free);
+  if (n_external_data != 0)
+    {
+      tmp_info.external_data = peas_plugin_parser_alloc (parser,
+                                                         (n_external_data * 2 + 1) *
+                                                         sizeof (gchar *));
 
-      g_hash_table_insert (info->external_data,
-                           g_strdup (keys[i] + 2),
-                           g_key_file_get_string (plugin_file, "Plugin",
-                                                  keys[i], NULL));
-    }
+      for (i = 0, n_external_data = 0; keys[i] != NULL; ++i)
+        {
+          const gchar *value;
 
-  g_strfreev (keys);
+          if (!g_str_has_prefix (keys[i], "X-"))
+            continue;
 
-  g_free (loader);
-  g_bytes_unref (bytes);
-  g_key_file_free (plugin_file);
+          /* Invalid values are treated as missing */
+          value = peas_plugin_parser_get_string (parser, keys[i]);
+          if (value == NULL)
+            continue;
 
-  info->filename = g_strdup (filename);
-  info->module_dir = g_strdup (module_dir);
-  info->data_dir = g_build_path (is_resource ? "/" : G_DIR_SEPARATOR_S,
-                                 data_dir, info->module_name, NULL);
+          tmp_info.external_data[n_external_data++] = keys[i] + 2;
+          tmp_info.external_data[n_external_data++] = (gchar *) value;
+        }
+
+      tmp_info.external_data[n_external_data] = NULL;
+    }
+
+  tmp_info.refcount = 1;
+  tmp_info.filename = (gchar *) filename;
+  tmp_info.module_dir = (gchar *) module_dir;
+  tmp_info.static_plugin = static_plugin;
+
+  if (static_plugin != NULL)
+    {
+      tmp_info.data_dir = (gchar *) data_dir;
+    }
+  else
+    {
+      tmp_info.data_dir = build_data_dir (parser, data_dir,
+                                          tmp_info.module_name,
+                                          is_resource ? '/' : G_DIR_SEPARATOR);
+    }
 
   /* If we know nothing about the availability of the plugin,
      set it as available */
-  info->available = TRUE;
+  tmp_info.available = TRUE;
+
+  return plugin_info_pack (&tmp_info);
+}
+
+/*
+ * _peas_plugin_info_new:
+ * @parser: The parser to use for the plugin file.
+ * @filename: The filename where to read the plugin information.
+ * @module_dir: The module directory.
+ * @data_dir: The data directory.
+ *
+ * Creates a new #PeasPluginInfo from a file on the disk.
+ *
+ * Return value: a newly created #PeasPluginInfo.
+ */
+PeasPluginInfo *
+_peas_plugin_info_new (PeasPluginParser *parser,
+                       const gchar      *filename,
+                       const gchar      *module_dir,
+                       const gchar      *data_dir)
+{
+  PeasPluginInfo *info;
+  GBytes *bytes = NULL;
+  GError *error = NULL;
+
+  g_return_val_if_fail (parser != NULL, NULL);
+  g_return_val_if_fail (filename != NULL, NULL);
+
+  if (g_str_has_prefix (filename, "resource://"))
+    {
+      /* This does not copy the data unless the resource is compressed */
+      bytes = g_resources_lookup_data (filename + strlen ("resource://"),
+                                       G_RESOURCE_LOOKUP_FLAGS_NONE,
+                                       &error);
+    }
+  else
+    {
+      gchar *content;
+      gsize length;
+
+      if (g_file_get_contents (filename, &content, &length, &error))
+        bytes = g_bytes_new_take (content, length);
+    }
+
+  if (bytes == NULL)
+    {
+      g_warning ("Bad plugin file '%s': %s", filename, error->message);
+      g_error_free (error);
+      return NULL;
+    }
+
+  info = plugin_info_new (parser, filename,
+                          g_bytes_get_data (bytes, NULL),
+                          g_bytes_get_size (bytes),
+                          module_dir, data_dir, NULL);
+
+  g_bytes_unref (bytes);
 
   return info;
+}
 
-error:
+/*
+ * _peas_plugin_info_new_static:
+ * @parser: The parser to use for the plugin's metadata.
+ * @static_plugin: The #PeasStaticPlugin.
+ *
+ * Creates a new #PeasPluginInfo for a static plugin.
+ *
+ * Return value: a newly created #PeasPluginInfo.
+ */
+PeasPluginInfo *
+_peas_plugin_info_new_static (PeasPluginParser       *parser,
+                              const PeasStaticPlugin *static_plugin)
+{
+  gsize module_name_len;
+  gchar *filename;
 
-  g_free (info->embedded);
-  g_free (loader);
-  g_free (info->module_name);
-  g_free (info->name);
-  g_free (info);
-  g_clear_pointer (&bytes, g_bytes_unref);
-  g_key_file_free (plugin_file);
+  g_return_val_if_fail (parser != NULL, NULL);
+  g_return_val_if_fail (static_plugin != NULL, NULL);
 
-  return NULL;
+  /* Static plugins do not have files but the
+   * C loader identifies its modules by filename
+   */
+  module_name_len = strlen (static_plugin->module_name);
+  filename = g_newa (gchar, strlen ("static://") + module_name_len + 1);
+  memcpy (g_stpcpy (filename, "static://"),
+          static_plugin->module_name, module_name_len + 1);
+
+  return plugin_info_new (parser, filename,
+                          static_plugin->metadata,
+                          strlen (static_plugin->metadata),
+                          "static://", filename, static_plugin);
 }
 
 /**
@@ -491,6 +730,159 @@ peas_plugin_info_get_data_dir (const PeasPluginInfo *info)
   return info->data_dir;
 }
 
+static gboolean
+ensure_static_schema_source (PeasPluginInfo *info)
+{
+  GSettingsSchemaSource *default_source;
+
+  /* Static plugins install their schemas like the application */
+  default_source = g_settings_schema_source_get_default ();
+  if (default_source == NULL)
+    return FALSE;
+
+  info->schema_source = g_settings_schema_source_ref (default_source);
+  return TRUE;
+}
+
+static gchar *
+get_gschemas_compiled (PeasPluginInfo *info)
+{
+  return g_build_filename (info->module_dir, "gschemas.compiled", NULL);
+}
+
+static void
+shared_schema_source_free (SharedSchemaSource *shared)
+{
+  g_settings_schema_source_unref (shared->source);
+  g_slice_free (SharedSchemaSource, shared);
+}
+
+static gboolean
+create_schema_source (PeasPluginInfo *info)
+{
+  SharedSchemaSource *shared = NULL;
+  gchar *gschemas_compiled;
+  GStatBuf buf;
+
+  gschemas_compiled = get_gschemas_compiled (info);
+
+  if (g_stat (gschemas_compiled, &buf) != 0)
+    {
+      /* glib-compile-schemas already outputted a message */
+      g_free (gschemas_compiled);
+      return FALSE;
+    }
+
+  g_free (gschemas_compiled);
+
+  g_mutex_lock (&shared_schema_sources_lock);
+
+  if (shared_schema_sources == NULL)
+    {
+      shared_schema_sources =
+          g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                 (GDestroyNotify) shared_schema_source_free);
+    }
+  else
+    {
+      shared = g_hash_table_lookup (shared_schema_sources,
+                                    info->module_dir);
+
+      /* Plugins still using the old source keep it alive,
+       * it is replaced in the table below
+       */
+      if (shared != NULL &&
+          (shared->mtime != buf.st_mtime ||
+           shared->inode != buf.st_ino ||
+           shared->size != buf.st_size))
+        shared = NULL;
+    }
+
+  if (shared == NULL)
+    {
+      GSettingsSchemaSource *default_source;
+      GSettingsSchemaSource *source;
+
+      default_source = g_settings_schema_source_get_default ();
+      source = g_settings_schema_source_new_from_directory (info->module_dir,
+                                                            default_source,
+                                                            FALSE, NULL);
+
+      if (source != NULL)
+        {
+          shared = g_slice_new (SharedSchemaSource);
+          shared->source = source;
+          shared->n_users = 0;
+          shared->mtime = buf.st_mtime;
+          shared->inode = buf.st_ino;
+          shared->size = buf.st_size;
+
+          g_hash_table_replace (shared_schema_sources,
+                                g_strdup (info->module_dir), shared);
+        }
+    }
+
+  if (shared != NULL)
+    {
+      shared->n_users++;
+      info->schema_source = g_settings_schema_source_ref (shared->source);
+    }
+
+  g_mutex_unlock (&shared_schema_sources_lock);
+
+  /* glib-compile-schemas already outputted a message */
+  return info->schema_source != NULL;
+}
+
+static void
+release_schema_source (PeasPluginInfo *info)
+{
+  SharedSchemaSource *shared;
+
+  /* Static plugins use the default source */
+  if (info->static_plugin == NULL)
+    {
+      g_mutex_lock (&shared_schema_sources_lock);
+
+      shared = g_hash_table_lookup (shared_schema_sources,
+                                    info->module_dir);
+
+      /* The source is not in the table if it was replaced
+       * after gschemas.compiled was recompiled
+       */
+      if (shared != NULL && shared->source == info->schema_source &&
+          --shared->n_users == 0)
+        g_hash_table_remove (shared_schema_sources, info->module_dir);
+
+      g_mutex_unlock (&shared_schema_sources_lock);
+    }
+
+  g_settings_schema_source_unref (info->schema_source);
+}
+
+static GSettings *
+lookup_settings (const PeasPluginInfo *info,
+                 const gchar          *schema_id)
+{
+  GSettingsSchema *schema;
+  GSettings *settings;
+
+  if (schema_id == NULL)
+    schema_id = info->module_name;
+
+  schema = g_settings_schema_source_lookup (info->schema_source, schema_id,
+                                            FALSE);
+
+  if (schema == NULL)
+    return NULL;
+
+  settings = g_settings_new_full (schema, NULL, NULL);
+
+  g_settings_schema_unref (schema);
+
+  return settings;
+}
+
 /**
  * peas_plugin_info_get_settings:
  * @info: A #PeasPluginInfo.
@@ -500,6 +892,10 @@ peas_plugin_info_get_data_dir (const PeasPluginInfo *info)
  * gschemas.compiled is not in the module directory an attempt
  * will be made to create it.
  *
+ * Creating gschemas.compiled spawns glib-compile-schemas and
+ * blocks until it exits, see peas_plugin_info_get_settings_async()
+ * for a version which does not block.
+ *
  * Returns: (transfer full): a new #GSettings, or %NULL.
  *
  * Since: 1.4
@@ -508,22 +904,23 @@ GSettings *
 peas_plugin_info_get_settings (const PeasPluginInfo *info,
                                const gchar          *schema_id)
 {
-  GSettingsSchema *schema;
-  GSettings *settings;
+  PeasPluginInfo *mutable_info = (PeasPluginInfo *) info;
 
   g_return_val_if_fail (info != NULL, NULL);
 
+  if (info->schema_source == NULL && info->static_plugin != NULL)
+    {
+      if (!ensure_static_schema_source (mutable_info))
+        return NULL;
+    }
+
   if (info->schema_source == NULL)
     {
-      GFile *module_dir_location;
-      GFile *gschema_compiled;
-      GSettingsSchemaSource *default_source;
+      gchar *gschemas_compiled;
 
-      module_dir_location = g_file_new_for_path (info->module_dir);
-      gschema_compiled = g_file_get_child (module_dir_location,
-                                           "gschemas.compiled");
+      gschemas_compiled = get_gschemas_compiled (mutable_info);
 
-      if (!g_file_query_exists (gschema_compiled, NULL))
+      if (!g_file_test (gschemas_compiled, G_FILE_TEST_EXISTS))
         {
           const gchar *argv[] = {
             "glib-compile-schemas",
@@ -536,34 +933,178 @@ peas_plugin_info_get_settings (const PeasPluginInfo *info,
                         NULL, NULL, NULL, NULL, NULL, NULL);
         }
 
-      g_object_unref (gschema_compiled);
-      g_object_unref (module_dir_location);
-
-      default_source = g_settings_schema_source_get_default ();
-      ((PeasPluginInfo *) info)->schema_source =
-            g_settings_schema_source_new_from_directory (info->module_dir,
-                                                         default_source,
-                                                         FALSE, NULL);
+      g_free (gschemas_compiled);
 
-      /* glib-compile-schemas already outputted a message */
-      if (info->schema_source == NULL)
+      if (!create_schema_source (mutable_info))
         return NULL;
     }
 
-  if (schema_id == NULL)
-    schema_id = info->module_name;
+  return lookup_settings (info, schema_id);
+}
 
-  schema = g_settings_schema_source_lookup (info->schema_source, schema_id,
-                                            FALSE);
+typedef struct {
+  PeasPluginInfo *info;
+  gchar *schema_id;
+} GetSettingsData;
 
-  if (schema == NULL)
-    return NULL;
+static void
+get_settings_data_free (GetSettingsData *data)
+{
+  _peas_plugin_info_unref (data->info);
+  g_free (data->schema_id);
+  g_slice_free (GetSettingsData, data);
+}
 
-  settings = g_settings_new_full (schema, NULL, NULL);
+static void
+get_settings_return (GTask *task)
+{
+  GetSettingsData *data = g_task_get_task_data (task);
 
-  g_settings_schema_unref (schema);
+  /* Another call might have created it in the meantime */
+  if (data->info->schema_source == NULL &&
+      !create_schema_source (data->info))
+    {
+      g_task_return_pointer (task, NULL, NULL);
+      return;
+    }
 
-  return settings;
+  g_task_return_pointer (task, lookup_settings (data->info, data->schema_id),
+                         g_object_unref);
+}
+
+static void
+compile_schemas_cb (GObject      *source_object,
+                    GAsyncResult *result,
+                    gpointer      user_data)
+{
+  GTask *task = G_TASK (user_data);
+  GError *error = NULL;
+
+  /* A failure to compile is treated like the sync version
+   * does, only cancellation and spawn errors are reported
+   */
+  if (!g_subprocess_wait_finish (G_SUBPROCESS (source_object),
+                                 result, &error))
+    g_task_return_error (task, error);
+  else
+    get_settings_return (task);
+
+  g_object_unref (task);
+}
+
+/**
+ * peas_plugin_info_get_settings_async:
+ * @info: A #PeasPluginInfo.
+ * @schema_id: (allow-none): The schema id.
+ * @cancellable: (allow-none): A #GCancellable.
+ * @callback: (scope async): A #GAsyncReadyCallback.
+ * @user_data: (closure): The data to pass to @callback.
+ *
+ * Asynchronously creates a new #GSettings for the given @schema_id,
+ * like peas_plugin_info_get_settings() but without blocking while
+ * gschemas.compiled is created.
+ *
+ * Call peas_plugin_info_get_settings_finish() from @callback
+ * to get the result.
+ *
+ * Since: 1.22
+ */
+void
+peas_plugin_info_get_settings_async (const PeasPluginInfo *info,
+                                     const gchar          *schema_id,
+                                     GCancellable         *cancellable,
+                                     GAsyncReadyCallback   callback,
+                                     gpointer              user_data)
+{
+  PeasPluginInfo *mutable_info = (PeasPluginInfo *) info;
+  GTask *task;
+  GetSettingsData *data;
+  gchar *gschemas_compiled;
+  GSubprocess *subprocess;
+  GError *error = NULL;
+
+  g_return_if_fail (info != NULL);
+  g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+  task = g_task_new (NULL, cancellable, callback, user_data);
+  g_task_set_source_tag (task, peas_plugin_info_get_settings_async);
+
+  data = g_slice_new (GetSettingsData);
+  data->info = _peas_plugin_info_ref (mutable_info);
+  data->schema_id = g_strdup (schema_id);
+  g_task_set_task_data (task, data,
+                        (GDestroyNotify) get_settings_data_free);
+
+  if (info->schema_source == NULL && info->static_plugin != NULL)
+    {
+      if (!ensure_static_schema_source (mutable_info))
+        {
+          g_task_return_pointer (task, NULL, NULL);
+          g_object_unref (task);
+          return;
+        }
+    }
+
+  if (info->schema_source != NULL)
+    {
+      get_settings_return (task);
+      g_object_unref (task);
+      return;
+    }
+
+  gschemas_compiled = get_gschemas_compiled (mutable_info);
+
+  if (g_file_test (gschemas_compiled, G_FILE_TEST_EXISTS))
+    {
+      g_free (gschemas_compiled);
+      get_settings_return (task);
+      g_object_unref (task);
+      return;
+    }
+
+  g_free (gschemas_compiled);
+
+  subprocess = g_subprocess_new (G_SUBPROCESS_FLAGS_NONE, &error,
+                                 "glib-compile-schemas",
+                                 "--targetdir", info->module_dir,
+                                 info->module_dir, NULL);
+
+  if (subprocess == NULL)
+    {
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      return;
+    }
+
+  g_subprocess_wait_async (subprocess, cancellable,
+                           compile_schemas_cb, task);
+  g_object_unref (subprocess);
+}
+
+/**
+ * peas_plugin_info_get_settings_finish:
+ * @info: A #PeasPluginInfo.
+ * @result: The #GAsyncResult passed to the #GAsyncReadyCallback.
+ * @error: A #GError, or %NULL.
+ *
+ * Finishes a call to peas_plugin_info_get_settings_async().
+ *
+ * %NULL is returned without setting @error if the schema
+ * does not exist, as with peas_plugin_info_get_settings().
+ *
+ * Returns: (transfer full): a new #GSettings, or %NULL.
+ *
+ * Since: 1.22
+ */
+GSettings *
+peas_plugin_info_get_settings_finish (const PeasPluginInfo  *info,
+                                      GAsyncResult          *result,
+                                      GError               **error)
+{
+  g_return_val_if_fail (info != NULL, NULL);
+  g_return_val_if_fail (g_task_is_valid (result, NULL), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
 }
 
 /**
@@ -800,14 +1341,19 @@ const gchar *
 peas_plugin_info_get_external_data (const PeasPluginInfo *info,
                                     const gchar          *key)
 {
+  guint i;
+
   g_return_val_if_fail (info != NULL, NULL);
   g_return_val_if_fail (key != NULL, NULL);
 
-  if (info->external_data == NULL)
-    return NULL;
-
   if (g_str_has_prefix (key, "X-"))
     key += 2;
 
-  return g_hash_table_lookup (info->external_data, key);
+  for (i = 0; info->external_data[i] != NULL; i += 2)
+    {
+      if (strcmp (info->external_data[i], key) == 0)
+        return info->external_data[i + 1];
+    }
+
+  return NULL;
 }
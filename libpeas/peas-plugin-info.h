@@ -82,6 +82,16 @@ const gchar  *peas_plugin_info_get_module_dir   (const PeasPluginInfo *info);
 const gchar  *peas_plugin_info_get_data_dir     (const PeasPluginInfo *info);
 GSettings    *peas_plugin_info_get_settings     (const PeasPluginInfo *info,
                                                  const gchar          *schema_id);
+void          peas_plugin_info_get_settings_async
+                                                (const PeasPluginInfo *info,
+                                                 const gchar          *schema_id,
+                                                 GCancellable         *cancellable,
+                                                 GAsyncReadyCallback   callback,
+                                                 gpointer              user_data);
+GSettings    *peas_plugin_info_get_settings_finish
+                                                (const PeasPluginInfo *info,
+                                                 GAsyncResult         *result,
+                                                 GError              **error);
 const gchar **peas_plugin_info_get_dependencies (const PeasPluginInfo *info);
 gboolean      peas_plugin_info_has_dependency   (const PeasPluginInfo *info,
                                                  const gchar          *module_name);
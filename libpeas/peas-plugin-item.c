@@ -0,0 +1,179 @@
+/*
+ * peas-plugin-item.c
+ * This file is part of libpeas
+ *
+ * Copyright (C) 2017 Garrett Regier
+ *
+ * libpeas is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libpeas is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "peas-plugin-item.h"
+#include "peas-plugin-info-priv.h"
+
+/**
+ * SECTION:peas-plugin-item
+ * @short_description: The items of the plugin list model.
+ * @see_also: #PeasEngine
+ *
+ * #PeasEngine implements #GListModel to provide a view of its plugin
+ * list, in the same order as peas_engine_get_plugin_list(). As the
+ * items of a #GListModel must be objects, each #PeasPluginInfo is
+ * wrapped by a #PeasPluginItem.
+ *
+ * The model emits #GListModel::items-changed just before the
+ * #PeasEngine::plugin-added and #PeasEngine::plugin-removed signals.
+ **/
+
+/**
+ * PeasPluginItem:
+ *
+ * The #PeasPluginItem structure contains only private data and should only
+ * be accessed using the provided API.
+ *
+ * Since: 1.22
+ */
+struct _PeasPluginItem {
+  GObject parent;
+
+  PeasPluginInfo *info;
+};
+
+struct _PeasPluginItemClass {
+  GObjectClass parent_class;
+};
+
+/* properties */
+enum {
+  PROP_0,
+  PROP_PLUGIN_INFO,
+  N_PROPERTIES
+};
+
+static GParamSpec *properties[N_PROPERTIES] = { NULL };
+
+G_DEFINE_TYPE (PeasPluginItem, peas_plugin_item, G_TYPE_OBJECT)
+
+static void
+peas_plugin_item_init (PeasPluginItem *item)
+{
+}
+
+static void
+peas_plugin_item_get_property (GObject    *object,
+                               guint       prop_id,
+                               GValue     *value,
+                               GParamSpec *pspec)
+{
+  PeasPluginItem *item = PEAS_PLUGIN_ITEM (object);
+
+  switch (prop_id)
+    {
+    case PROP_PLUGIN_INFO:
+      g_value_set_boxed (value, item->info);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+peas_plugin_item_set_property (GObject      *object,
+                               guint         prop_id,
+                               const GValue *value,
+                               GParamSpec   *pspec)
+{
+  PeasPluginItem *item = PEAS_PLUGIN_ITEM (object);
+
+  switch (prop_id)
+    {
+    case PROP_PLUGIN_INFO:
+      item->info = g_value_dup_boxed (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+peas_plugin_item_finalize (GObject *object)
+{
+  PeasPluginItem *item = PEAS_PLUGIN_ITEM (object);
+
+  if (item->info != NULL)
+    _peas_plugin_info_unref (item->info);
+
+  G_OBJECT_CLASS (peas_plugin_item_parent_class)->finalize (object);
+}
+
+static void
+peas_plugin_item_class_init (PeasPluginItemClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->get_property = peas_plugin_item_get_property;
+  object_class->set_property = peas_plugin_item_set_property;
+  object_class->finalize = peas_plugin_item_finalize;
+
+  /**
+   * PeasPluginItem:plugin-info:
+   *
+   * The #PeasPluginInfo wrapped by the item.
+   *
+   * Since: 1.22
+   */
+  properties[PROP_PLUGIN_INFO] =
+    g_param_spec_boxed ("plugin-info",
+                        "Plugin Information",
+                        "Information related to the current plugin",
+                        PEAS_TYPE_PLUGIN_INFO,
+                        G_PARAM_READWRITE |
+                        G_PARAM_CONSTRUCT_ONLY |
+                        G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (object_class, N_PROPERTIES, properties);
+}
+
+PeasPluginItem *
+_peas_plugin_item_new (PeasPluginInfo *info)
+{
+  return g_object_new (PEAS_TYPE_PLUGIN_ITEM,
+                       "plugin-info", info,
+                       NULL);
+}
+
+/**
+ * peas_plugin_item_get_plugin_info:
+ * @item: A #PeasPluginItem.
+ *
+ * Get the #PeasPluginInfo wrapped by @item.
+ *
+ * Returns: (transfer none): the #PeasPluginInfo of the item.
+ *
+ * Since: 1.22
+ */
+PeasPluginInfo *
+peas_plugin_item_get_plugin_info (PeasPluginItem *item)
+{
+  g_return_val_if_fail (PEAS_IS_PLUGIN_ITEM (item), NULL);
+
+  return item->info;
+}
@@ -0,0 +1,48 @@
+/*
+ * peas-plugin-item.h
+ * This file is part of libpeas
+ *
+ * Copyright (C) 2017 Garrett Regier
+ *
+ * libpeas is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libpeas is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.
+ */
+
+
+#ifndef __PEAS_PLUGIN_ITEM_H__
+#define __PEAS_PLUGIN_ITEM_H__
+
+#include <glib-object.h>
+
+#include "peas-plugin-info.h"
+
+G_BEGIN_DECLS
+
+#define PEAS_TYPE_PLUGIN_ITEM            (peas_plugin_item_get_type ())
+#define PEAS_PLUGIN_ITEM(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj), PEAS_TYPE_PLUGIN_ITEM, PeasPluginItem))
+#define PEAS_PLUGIN_ITEM_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST((klass), PEAS_TYPE_PLUGIN_ITEM, PeasPluginItemClass))
+#define PEAS_IS_PLUGIN_ITEM(obj)         (G_TYPE_CHECK_INSTANCE_TYPE((obj), PEAS_TYPE_PLUGIN_ITEM))
+#define PEAS_IS_PLUGIN_ITEM_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), PEAS_TYPE_PLUGIN_ITEM))
+#define PEAS_PLUGIN_ITEM_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj), PEAS_TYPE_PLUGIN_ITEM, PeasPluginItemClass))
+
+typedef struct _PeasPluginItem       PeasPluginItem;
+typedef struct _PeasPluginItemClass  PeasPluginItemClass;
+
+GType           peas_plugin_item_get_type        (void) G_GNUC_CONST;
+
+PeasPluginInfo *peas_plugin_item_get_plugin_info (PeasPluginItem *item);
+
+G_END_DECLS
+
+#endif /* __PEAS_PLUGIN_ITEM_H__ */
@@ -30,6 +30,7 @@
 #include "peas-extension-base.h"
 #include "peas-object-module.h"
 #include "peas-plugin-info-priv.h"
+#include "peas-static-plugin-priv.h"
 
 typedef struct {
   GMutex lock;
@@ -65,7 +66,13 @@ peas_plugin_loader_c_load (PeasPluginLoader *loader,
       module_name = peas_plugin_info_get_module_name (info);
       module_dir = peas_plugin_info_get_module_dir (info);
 
-      if (info->embedded != NULL)
+      if (info->static_plugin != NULL)
+        {
+          info->loader_data =
+            _peas_object_module_new_static (module_name,
+                                            info->static_plugin->register_func);
+        }
+      else if (info->embedded != NULL)
         {
           info->loader_data = peas_object_module_new_embedded (module_name,
                                                                info->embedded);
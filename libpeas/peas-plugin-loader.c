@@ -132,6 +132,36 @@ peas_plugin_loader_create_extension (PeasPluginLoader *loader,
                                   n_parameters, parameters);
 }
 
+void
+peas_plugin_loader_create_extensions (PeasPluginLoader  *loader,
+                                      PeasPluginInfo   **infos,
+                                      guint              n_infos,
+                                      GType              ext_type,
+                                      guint              n_parameters,
+                                      GParameter        *parameters,
+                                      PeasExtension    **extensions)
+{
+  PeasPluginLoaderClass *klass;
+  guint i;
+
+  g_return_if_fail (PEAS_IS_PLUGIN_LOADER (loader));
+
+  klass = PEAS_PLUGIN_LOADER_GET_CLASS (loader);
+
+  if (klass->create_extensions != NULL)
+    {
+      klass->create_extensions (loader, infos, n_infos, ext_type,
+                                n_parameters, parameters, extensions);
+      return;
+    }
+
+  for (i = 0; i < n_infos; ++i)
+    {
+      extensions[i] = klass->create_extension (loader, infos[i], ext_type,
+                                               n_parameters, parameters);
+    }
+}
+
 void
 peas_plugin_loader_garbage_collect (PeasPluginLoader *loader)
 {
@@ -61,6 +61,13 @@ struct _PeasPluginLoaderClass {
                                            GType             ext_type,
                                            guint             n_parameters,
                                            GParameter       *parameters);
+  void           (*create_extensions)     (PeasPluginLoader *loader,
+                                           PeasPluginInfo  **infos,
+                                           guint             n_infos,
+                                           GType             ext_type,
+                                           guint             n_parameters,
+                                           GParameter       *parameters,
+                                           PeasExtension   **extensions);
 
   void           (*garbage_collect)       (PeasPluginLoader *loader);
 };
@@ -83,6 +90,13 @@ PeasExtension *peas_plugin_loader_create_extension    (PeasPluginLoader *loader,
                                                        GType             ext_type,
                                                        guint             n_parameters,
                                                        GParameter       *parameters);
+void          peas_plugin_loader_create_extensions    (PeasPluginLoader *loader,
+                                                       PeasPluginInfo  **infos,
+                                                       guint             n_infos,
+                                                       GType             ext_type,
+                                                       guint             n_parameters,
+                                                       GParameter       *parameters,
+                                                       PeasExtension   **extensions);
 void          peas_plugin_loader_garbage_collect      (PeasPluginLoader *loader);
 
 G_END_DECLS
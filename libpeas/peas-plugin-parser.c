@@ -0,0 +1,711 @@
+/*
+ * peas-plugin-parser.c
+ * This file is part of libpeas
+ *
+ * Copyright (C) 2017 Garrett Regier
+ *
+ * libpeas is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libpeas is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#include "peas-plugin-parser.h"
+
+/* A single pass parser for .plugin files which accepts the
+ * same syntax as GKeyFile but only records the keys of a
+ * single group, as spans into the caller's buffer.
+ *
+ * Values are copied and unescaped when they are asked for,
+ * into an arena that is reset for each file. The engine keeps
+ * a parser alive for a whole rescan so once the arena has
+ * grown large enough parsing a file does not allocate at all.
+ */
+
+#define ARENA_MIN_SIZE 4096
+
+typedef struct {
+  /* The full key, including any [locale] suffix */
+  const gchar *key;
+  gsize key_len;
+
+  /* The key without the [locale] suffix */
+  gsize name_len;
+
+  /* Index into the language names or -1 if not localized */
+  gint locale;
+
+  const gchar *value;
+  gsize value_len;
+} Entry;
+
+struct _PeasPluginParser {
+  guint8 *arena;
+  gsize arena_size;
+  gsize arena_used;
+
+  /* Arena blocks which were outgrown while parsing the current file */
+  GSList *retired;
+
+  GArray *entries;
+
+  const gchar * const *languages;
+};
+
+PeasPluginParser *
+peas_plugin_parser_new (void)
+{
+  PeasPluginParser *parser;
+
+  parser = g_slice_new0 (PeasPluginParser);
+  parser->entries = g_array_sized_new (FALSE, FALSE, sizeof (Entry), 32);
+  parser->languages = g_get_language_names ();
+
+  return parser;
+}
+
+void
+peas_plugin_parser_free (PeasPluginParser *parser)
+{
+  g_return_if_fail (parser != NULL);
+
+  g_slist_free_full (parser->retired, g_free);
+  g_free (parser->arena);
+  g_array_unref (parser->entries);
+
+  g_slice_free (PeasPluginParser, parser);
+}
+
+static gpointer
+arena_alloc (PeasPluginParser *parser,
+             gsize             size,
+             gsize             align)
+{
+  gsize offset;
+
+  offset = (parser->arena_used + align - 1) & ~(align - 1);
+
+  if (offset + size > parser->arena_size)
+    {
+      /* Pointers into the old block must stay valid until the
+       * next reset, afterwards only the larger block is kept
+       */
+      if (parser->arena != NULL)
+        parser->retired = g_slist_prepend (parser->retired, parser->arena);
+
+      parser->arena_size = MAX (parser->arena_size * 2, ARENA_MIN_SIZE);
+      parser->arena_size = MAX (parser->arena_size, size);
+      parser->arena = g_malloc (parser->arena_size);
+      offset = 0;
+    }
+
+  parser->arena_used = offset + size;
+  return parser->arena + offset;
+}
+
+static void
+parser_reset (PeasPluginParser *parser)
+{
+  g_slist_free_full (parser->retired, g_free);
+  parser->retired = NULL;
+  parser->arena_used = 0;
+
+  g_array_set_size (parser->entries, 0);
+}
+
+/*
+ * peas_plugin_parser_alloc:
+ * @parser: A #PeasPluginParser.
+ * @size: The number of bytes to allocate.
+ *
+ * Allocates pointer aligned memory from the parser's arena.
+ * The memory is only valid until the next file is parsed.
+ */
+gpointer
+peas_plugin_parser_alloc (PeasPluginParser *parser,
+                          gsize             size)
+{
+  g_return_val_if_fail (parser != NULL, NULL);
+
+  return arena_alloc (parser, size, sizeof (gpointer));
+}
+
+static gint
+get_locale_index (PeasPluginParser *parser,
+                  const gchar      *locale,
+                  gsize             locale_len)
+{
+  gint i;
+
+  for (i = 0; parser->languages[i] != NULL; ++i)
+    {
+      if (strncmp (parser->languages[i], locale, locale_len) == 0 &&
+          parser->languages[i][locale_len] == '\0')
+        return i;
+    }
+
+  return -1;
+}
+
+static gboolean
+parse_group (const gchar  *line,
+             const gchar  *line_end,
+             const gchar **name,
+             gsize        *name_len)
+{
+  const gchar *close, *p;
+
+  close = memchr (line, ']', line_end - line);
+  if (close == NULL || close == line + 1)
+    return FALSE;
+
+  for (p = line + 1; p < close; ++p)
+    {
+      if (*p == '[' || g_ascii_iscntrl (*p))
+        return FALSE;
+    }
+
+  /* Whitespace is silently accepted after the ']' */
+  for (p = close + 1; p < line_end; ++p)
+    {
+      if (*p != ' ' && *p != '\t')
+        return FALSE;
+    }
+
+  *name = line + 1;
+  *name_len = close - line - 1;
+  return TRUE;
+}
+
+static gboolean
+parse_key (const gchar *key,
+           gsize        key_len,
+           gsize       *name_len,
+           const gchar **locale,
+           gsize       *locale_len)
+{
+  const gchar *p, *end = key + key_len;
+
+  for (p = key; p < end && *p != '[' && *p != ']'; ++p)
+    ;
+
+  if (p == key || key[0] == ' ' || p[-1] == ' ')
+    return FALSE;
+
+  *name_len = p - key;
+  *locale = NULL;
+  *locale_len = 0;
+
+  if (p == end)
+    return TRUE;
+
+  if (*p != '[')
+    return FALSE;
+
+  for (++p; p < end; ++p)
+    {
+      if (!g_ascii_isalnum (*p) &&
+          *p != '-' && *p != '_' && *p != '.' && *p != '@')
+        break;
+    }
+
+  if (p != end - 1 || *p != ']')
+    return FALSE;
+
+  /* An empty locale is not a locale, like GKeyFile */
+  if (p != key + *name_len + 1)
+    {
+      *locale = key + *name_len + 1;
+      *locale_len = p - *locale;
+    }
+  else
+    {
+      *name_len = key_len;
+    }
+
+  return TRUE;
+}
+
+/*
+ * peas_plugin_parser_parse:
+ * @parser: A #PeasPluginParser.
+ * @data: The contents of the .plugin file.
+ * @length: The length of @data.
+ * @group: The group whose keys should be recorded.
+ * @error: A #GError.
+ *
+ * Parses @data, the same syntax errors as GKeyFile are reported.
+ * @data must be kept alive for as long as the values are used.
+ *
+ * Returns: %TRUE if @data was successfully parsed.
+ */
+gboolean
+peas_plugin_parser_parse (PeasPluginParser  *parser,
+                          const gchar       *data,
+                          gsize              length,
+                          const gchar       *group,
+                          GError           **error)
+{
+  const gchar *line, *data_end = data + length;
+  gsize group_len;
+  gboolean has_group = FALSE;
+  gboolean in_group = FALSE;
+
+  g_return_val_if_fail (parser != NULL, FALSE);
+  g_return_val_if_fail (data != NULL || length == 0, FALSE);
+  g_return_val_if_fail (group != NULL, FALSE);
+
+  parser_reset (parser);
+  group_len = strlen (group);
+
+  for (line = data; line < data_end; )
+    {
+      const gchar *line_end, *next_line;
+      const gchar *equals, *key_end, *value;
+      const gchar *locale;
+      gsize name_len, locale_len;
+      Entry *entry;
+
+      line_end = memchr (line, '\n', data_end - line);
+
+      if (line_end != NULL)
+        {
+          next_line = line_end + 1;
+        }
+      else
+        {
+          line_end = data_end;
+          next_line = data_end;
+        }
+
+      if (line_end > line && line_end[-1] == '\r')
+        line_end--;
+
+      while (line < line_end && g_ascii_isspace (*line))
+        line++;
+
+      if (line == line_end || *line == '#')
+        {
+          line = next_line;
+          continue;
+        }
+
+      if (*line == '[')
+        {
+          const gchar *name;
+
+          if (!parse_group (line, line_end, &name, &name_len))
+            {
+              g_set_error (error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_PARSE,
+                           "Invalid group name: %.*s",
+                           (gint) (line_end - line), line);
+              return FALSE;
+            }
+
+          has_group = TRUE;
+          in_group = name_len == group_len &&
+                     memcmp (name, group, group_len) == 0;
+
+          line = next_line;
+          continue;
+        }
+
+      equals = memchr (line, '=', line_end - line);
+      if (equals == NULL)
+        {
+          g_set_error (error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_PARSE,
+                       "Key file contains line '%.*s' which is not "
+                       "a key-value pair, group, or comment",
+                       (gint) (line_end - line), line);
+          return FALSE;
+        }
+
+      if (!has_group)
+        {
+          g_set_error_literal (error, G_KEY_FILE_ERROR,
+                               G_KEY_FILE_ERROR_GROUP_NOT_FOUND,
+                               "Key file does not start with a group");
+          return FALSE;
+        }
+
+      for (key_end = equals; key_end > line; --key_end)
+        {
+          if (!g_ascii_isspace (key_end[-1]))
+            break;
+        }
+
+      if (!parse_key (line, key_end - line,
+                      &name_len, &locale, &locale_len))
+        {
+          g_set_error (error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_PARSE,
+                       "Invalid key name: %.*s",
+                       (gint) (key_end - line), line);
+          return FALSE;
+        }
+
+      if (!in_group)
+        {
+          line = next_line;
+          continue;
+        }
+
+      for (value = equals + 1; value < line_end; ++value)
+        {
+          if (!g_ascii_isspace (*value))
+            break;
+        }
+
+      g_array_set_size (parser->entries, parser->entries->len + 1);
+      entry = &g_array_index (parser->entries, Entry,
+                              parser->entries->len - 1);
+
+      entry->key = line;
+      entry->key_len = key_end - line;
+      entry->name_len = name_len;
+      entry->locale = -1;
+      entry->value = value;
+      entry->value_len = line_end - value;
+
+      if (locale != NULL)
+        {
+          entry->locale = get_locale_index (parser, locale, locale_len);
+
+          /* Like GKeyFile, drop translations which will never be used */
+          if (entry->locale == -1)
+            g_array_set_size (parser->entries, parser->entries->len - 1);
+        }
+
+      line = next_line;
+    }
+
+  return TRUE;
+}
+
+static const Entry *
+lookup_entry (PeasPluginParser *parser,
+              const gchar      *key)
+{
+  gsize key_len = strlen (key);
+  guint i;
+
+  /* Later keys override earlier ones */
+  for (i = parser->entries->len; i > 0; --i)
+    {
+      const Entry *entry = &g_array_index (parser->entries, Entry, i - 1);
+
+      if (entry->key_len == key_len &&
+          memcmp (entry->key, key, key_len) == 0)
+        return entry;
+    }
+
+  return NULL;
+}
+
+static const Entry *
+lookup_locale_entry (PeasPluginParser *parser,
+                     const gchar      *key,
+                     gint              locale)
+{
+  gsize key_len = strlen (key);
+  guint i;
+
+  for (i = parser->entries->len; i > 0; --i)
+    {
+      const Entry *entry = &g_array_index (parser->entries, Entry, i - 1);
+
+      if (entry->locale == locale &&
+          entry->name_len == key_len &&
+          memcmp (entry->key, key, key_len) == 0)
+        return entry;
+    }
+
+  return NULL;
+}
+
+static gboolean
+unescape_value (gchar  *str,
+                gchar **pieces,
+                guint  *n_pieces)
+{
+  gchar *p, *q, *piece;
+
+  for (p = q = piece = str; *p != '\0'; ++p, ++q)
+    {
+      if (*p == '\\')
+        {
+          switch (*++p)
+            {
+            case 's':
+              *q = ' ';
+              break;
+            case 'n':
+              *q = '\n';
+              break;
+            case 't':
+              *q = '\t';
+              break;
+            case 'r':
+              *q = '\r';
+              break;
+            case '\\':
+              *q = '\\';
+              break;
+            case ';':
+              if (pieces != NULL)
+                {
+                  *q = ';';
+                  break;
+                }
+
+              /* Fall through */
+            default:
+              /* Invalid escape sequence or escape at the end of the line */
+              return FALSE;
+            }
+        }
+      else if (*p == ';' && pieces != NULL)
+        {
+          *q = '\0';
+          pieces[(*n_pieces)++] = piece;
+          piece = q + 1;
+        }
+      else
+        {
+          *q = *p;
+        }
+    }
+
+  *q = '\0';
+
+  /* A trailing separator does not start a new piece */
+  if (pieces != NULL && piece < q)
+    pieces[(*n_pieces)++] = piece;
+
+  return TRUE;
+}
+
+static gchar *
+copy_value (PeasPluginParser *parser,
+            const Entry      *entry)
+{
+  gchar *str;
+
+  if (!g_utf8_validate (entry->value, entry->value_len, NULL))
+    return NULL;
+
+  str = arena_alloc (parser, entry->value_len + 1, 1);
+  memcpy (str, entry->value, entry->value_len);
+  str[entry->value_len] = '\0';
+
+  return str;
+}
+
+static const gchar *
+entry_get_string (PeasPluginParser *parser,
+                  const Entry      *entry)
+{
+  gchar *str;
+
+  if (entry == NULL)
+    return NULL;
+
+  str = copy_value (parser, entry);
+
+  if (str == NULL || !unescape_value (str, NULL, NULL))
+    return NULL;
+
+  return str;
+}
+
+/*
+ * peas_plugin_parser_get_string:
+ * @parser: A #PeasPluginParser.
+ * @key: The key.
+ *
+ * Like g_key_file_get_string() but the returned
+ * string is owned by the parser's arena.
+ *
+ * Returns: the unescaped value of @key or %NULL.
+ */
+const gchar *
+peas_plugin_parser_get_string (PeasPluginParser *parser,
+                               const gchar      *key)
+{
+  g_return_val_if_fail (parser != NULL, NULL);
+  g_return_val_if_fail (key != NULL, NULL);
+
+  return entry_get_string (parser, lookup_entry (parser, key));
+}
+
+/*
+ * peas_plugin_parser_get_locale_string:
+ * @parser: A #PeasPluginParser.
+ * @key: The key.
+ *
+ * Like g_key_file_get_locale_string() for the current locale but
+ * the returned string is owned by the parser's arena.
+ *
+ * Returns: the best translation of @key or %NULL.
+ */
+const gchar *
+peas_plugin_parser_get_locale_string (PeasPluginParser *parser,
+                                      const gchar      *key)
+{
+  gint i;
+
+  g_return_val_if_fail (parser != NULL, NULL);
+  g_return_val_if_fail (key != NULL, NULL);
+
+  for (i = 0; parser->languages[i] != NULL; ++i)
+    {
+      const gchar *str;
+
+      str = entry_get_string (parser, lookup_locale_entry (parser, key, i));
+      if (str != NULL)
+        return str;
+    }
+
+  return entry_get_string (parser, lookup_locale_entry (parser, key, -1));
+}
+
+/*
+ * peas_plugin_parser_get_string_list:
+ * @parser: A #PeasPluginParser.
+ * @key: The key.
+ *
+ * Like g_key_file_get_string_list() but the returned
+ * list and its strings are owned by the parser's arena.
+ *
+ * Returns: a %NULL-terminated list or %NULL.
+ */
+gchar **
+peas_plugin_parser_get_string_list (PeasPluginParser *parser,
+                                    const gchar      *key)
+{
+  const Entry *entry;
+  gchar **strv;
+  gchar *str;
+  guint n_pieces = 1;
+  gsize i;
+
+  g_return_val_if_fail (parser != NULL, NULL);
+  g_return_val_if_fail (key != NULL, NULL);
+
+  entry = lookup_entry (parser, key);
+  if (entry == NULL)
+    return NULL;
+
+  /* There cannot be more pieces than separators plus one */
+  for (i = 0; i < entry->value_len; ++i)
+    {
+      if (entry->value[i] == ';')
+        n_pieces++;
+    }
+
+  strv = arena_alloc (parser, (n_pieces + 1) * sizeof (gchar *),
+                      sizeof (gchar *));
+
+  str = copy_value (parser, entry);
+  n_pieces = 0;
+
+  if (str == NULL || !unescape_value (str, strv, &n_pieces))
+    return NULL;
+
+  strv[n_pieces] = NULL;
+  return strv;
+}
+
+/*
+ * peas_plugin_parser_get_boolean:
+ * @parser: A #PeasPluginParser.
+ * @key: The key.
+ *
+ * Like g_key_file_get_boolean().
+ *
+ * Returns: the value of @key or %FALSE if it is missing or invalid.
+ */
+gboolean
+peas_plugin_parser_get_boolean (PeasPluginParser *parser,
+                                const gchar      *key)
+{
+  const Entry *entry;
+  gsize len;
+
+  g_return_val_if_fail (parser != NULL, FALSE);
+  g_return_val_if_fail (key != NULL, FALSE);
+
+  entry = lookup_entry (parser, key);
+  if (entry == NULL)
+    return FALSE;
+
+  len = entry->value_len;
+  while (len > 0 && g_ascii_isspace (entry->value[len - 1]))
+    len--;
+
+  return (len == 4 && strncmp (entry->value, "true", 4) == 0) ||
+         (len == 1 && entry->value[0] == '1');
+}
+
+/*
+ * peas_plugin_parser_get_keys:
+ * @parser: A #PeasPluginParser.
+ *
+ * Like g_key_file_get_keys() but the returned
+ * list and its strings are owned by the parser's arena.
+ *
+ * Returns: a %NULL-terminated list of the keys in the file order.
+ */
+gchar **
+peas_plugin_parser_get_keys (PeasPluginParser *parser)
+{
+  gchar **keys;
+  guint i, j, n_keys = 0;
+
+  g_return_val_if_fail (parser != NULL, NULL);
+
+  keys = arena_alloc (parser, (parser->entries->len + 1) * sizeof (gchar *),
+                      sizeof (gchar *));
+
+  for (i = 0; i < parser->entries->len; ++i)
+    {
+      const Entry *entry = &g_array_index (parser->entries, Entry, i);
+      gchar *key;
+
+      for (j = 0; j < i; ++j)
+        {
+          const Entry *other = &g_array_index (parser->entries, Entry, j);
+
+          if (other->key_len == entry->key_len &&
+              memcmp (other->key, entry->key, entry->key_len) == 0)
+            break;
+        }
+
+      /* Already added */
+      if (j != i)
+        continue;
+
+      key = arena_alloc (parser, entry->key_len + 1, 1);
+      memcpy (key, entry->key, entry->key_len);
+      key[entry->key_len] = '\0';
+
+      keys[n_keys++] = key;
+    }
+
+  keys[n_keys] = NULL;
+  return keys;
+}
@@ -0,0 +1,55 @@
+/*
+ * peas-plugin-parser.h
+ * This file is part of libpeas
+ *
+ * Copyright (C) 2017 Garrett Regier
+ *
+ * libpeas is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libpeas is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.
+ */
+
+#ifndef __PEAS_PLUGIN_PARSER_H__
+#define __PEAS_PLUGIN_PARSER_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _PeasPluginParser PeasPluginParser;
+
+PeasPluginParser  *peas_plugin_parser_new               (void);
+void               peas_plugin_parser_free              (PeasPluginParser *parser);
+
+gboolean           peas_plugin_parser_parse             (PeasPluginParser *parser,
+                                                         const gchar      *data,
+                                                         gsize             length,
+                                                         const gchar      *group,
+                                                         GError          **error);
+
+gpointer           peas_plugin_parser_alloc             (PeasPluginParser *parser,
+                                                         gsize             size);
+
+const gchar       *peas_plugin_parser_get_string        (PeasPluginParser *parser,
+                                                         const gchar      *key);
+const gchar       *peas_plugin_parser_get_locale_string (PeasPluginParser *parser,
+                                                         const gchar      *key);
+gchar            **peas_plugin_parser_get_string_list   (PeasPluginParser *parser,
+                                                         const gchar      *key);
+gboolean           peas_plugin_parser_get_boolean       (PeasPluginParser *parser,
+                                                         const gchar      *key);
+gchar            **peas_plugin_parser_get_keys          (PeasPluginParser *parser);
+
+G_END_DECLS
+
+#endif /* __PEAS_PLUGIN_PARSER_H__ */
@@ -0,0 +1,36 @@
+/*
+ * peas-static-plugin-priv.h
+ * This file is part of libpeas
+ *
+ * Copyright (C) 2017 Garrett Regier
+ *
+ * libpeas is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libpeas is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.
+ */
+
+#ifndef __PEAS_STATIC_PLUGIN_PRIV_H__
+#define __PEAS_STATIC_PLUGIN_PRIV_H__
+
+#include "peas-static-plugin.h"
+
+G_BEGIN_DECLS
+
+const PeasStaticPlugin *_peas_static_plugin_get_list    (void);
+
+PeasObjectModule       *_peas_object_module_new_static (const gchar                  *module_name,
+                                                        PeasStaticPluginRegisterFunc  register_func);
+
+G_END_DECLS
+
+#endif /* __PEAS_STATIC_PLUGIN_PRIV_H__ */
@@ -0,0 +1,96 @@
+/*
+ * peas-static-plugin.c
+ * This file is part of libpeas
+ *
+ * Copyright (C) 2017 Garrett Regier
+ *
+ * libpeas is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libpeas is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "peas-static-plugin-priv.h"
+
+/**
+ * SECTION:peas-static-plugin
+ * @short_description: C plugins which are linked into the application.
+ * @see_also: #PeasObjectModule
+ *
+ * A static plugin is a C plugin that is compiled into the application,
+ * or into a library it links to, together with its metadata. Unlike
+ * embedded plugins, no .plugin file has to be found and no symbols
+ * have to be looked up to use it.
+ *
+ * Static plugins are defined with PEAS_DEFINE_STATIC_PLUGIN() and are
+ * known to every #PeasEngine, regardless of its search paths. Only the
+ * first plugin found with a given module name is used, static plugins
+ * are looked at before the search paths so they take precedence over
+ * plugins with the same module name. However, a static plugin that is
+ * registered after an engine has already found a plugin with the same
+ * module name is ignored by that engine.
+ **/
+
+/* Plugins are only ever prepended so the list can be
+ * walked without the lock once its head has been read
+ */
+static GMutex static_plugins_lock;
+static PeasStaticPlugin *static_plugins = NULL;
+
+/**
+ * peas_static_plugin_register: (skip)
+ * @plugin: A #PeasStaticPlugin.
+ *
+ * Registers @plugin so that it will be found by every #PeasEngine.
+ * @plugin must stay alive for the rest of the program and must not
+ * be registered more than once.
+ *
+ * Engines which already exist will only find @plugin after
+ * peas_engine_rescan_plugins() is called.
+ *
+ * This is usually not called directly, see PEAS_DEFINE_STATIC_PLUGIN().
+ *
+ * Since: 1.22
+ */
+void
+peas_static_plugin_register (PeasStaticPlugin *plugin)
+{
+  g_return_if_fail (plugin != NULL);
+  g_return_if_fail (plugin->module_name != NULL &&
+                    *plugin->module_name != '\0');
+  g_return_if_fail (plugin->metadata != NULL);
+  g_return_if_fail (plugin->register_func != NULL);
+  g_return_if_fail (plugin->next == NULL);
+
+  g_mutex_lock (&static_plugins_lock);
+
+  plugin->next = static_plugins;
+  static_plugins = plugin;
+
+  g_mutex_unlock (&static_plugins_lock);
+}
+
+const PeasStaticPlugin *
+_peas_static_plugin_get_list (void)
+{
+  const PeasStaticPlugin *list;
+
+  g_mutex_lock (&static_plugins_lock);
+  list = static_plugins;
+  g_mutex_unlock (&static_plugins_lock);
+
+  return list;
+}
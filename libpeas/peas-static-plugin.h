@@ -0,0 +1,146 @@
+/*
+ * peas-static-plugin.h
+ * This file is part of libpeas
+ *
+ * Copyright (C) 2017 Garrett Regier
+ *
+ * libpeas is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libpeas is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.
+ */
+
+#ifndef __PEAS_STATIC_PLUGIN_H__
+#define __PEAS_STATIC_PLUGIN_H__
+
+#include <glib.h>
+
+#include "peas-object-module.h"
+
+G_BEGIN_DECLS
+
+typedef struct _PeasStaticPlugin PeasStaticPlugin;
+
+/**
+ * PeasStaticPluginRegisterFunc:
+ * @module: The #PeasObjectModule of the plugin.
+ *
+ * The function which registers the extensions of a static plugin,
+ * it is the equivalent of a C plugin's peas_register_types().
+ *
+ * Since: 1.22
+ */
+typedef void (*PeasStaticPluginRegisterFunc) (PeasObjectModule *module);
+
+/**
+ * PeasStaticPlugin: (skip)
+ * @module_name: The module name of the plugin.
+ * @metadata: The contents of the plugin's .plugin file.
+ * @register_func: The function which registers the plugin's extensions.
+ *
+ * A #PeasStaticPlugin describes a C plugin which is linked into
+ * the application. It is usually defined by
+ * PEAS_DEFINE_STATIC_PLUGIN().
+ *
+ * Since: 1.22
+ */
+struct _PeasStaticPlugin {
+  const gchar *module_name;
+  const gchar *metadata;
+  PeasStaticPluginRegisterFunc register_func;
+
+  /*< private >*/
+  PeasStaticPlugin *next;
+};
+
+void peas_static_plugin_register (PeasStaticPlugin *plugin);
+
+#if defined (__GNUC__)
+
+#define _PEAS_STATIC_PLUGIN_CONSTRUCTOR(func) \
+  static void func (void) __attribute__ ((constructor)); \
+  static void func (void)
+
+#elif defined (_MSC_VER)
+
+#if defined (_M_IX86)
+#define _PEAS_STATIC_PLUGIN_SYMBOL_PREFIX "_"
+#else
+#define _PEAS_STATIC_PLUGIN_SYMBOL_PREFIX ""
+#endif
+
+/* Like GLib's G_DEFINE_CONSTRUCTOR(), the pointer must not be
+ * static and must be forcibly included otherwise the linker
+ * can discard it as nothing references it.
+ */
+#define _PEAS_STATIC_PLUGIN_CONSTRUCTOR(func) \
+  static void func (void); \
+  __pragma (section (".CRT$XCU", read)) \
+  __declspec (allocate (".CRT$XCU")) \
+  void (*func##_ptr) (void) = func; \
+  __pragma (comment (linker, "/include:" \
+                     _PEAS_STATIC_PLUGIN_SYMBOL_PREFIX #func "_ptr")) \
+  static void func (void)
+
+#endif
+
+/**
+ * PEAS_DEFINE_STATIC_PLUGIN:
+ * @module_name: The module name of the plugin.
+ * @metadata: The contents of the plugin's .plugin file.
+ * @register_func: The name of the plugin's #PeasStaticPluginRegisterFunc.
+ *
+ * Defines a #PeasStaticPlugin and registers it when the program,
+ * or the library containing it, is loaded. Every #PeasEngine will
+ * then know about the plugin without looking it up on the disk or
+ * in a #GResource and without having to lookup any symbols.
+ *
+ * The "Module" key of @metadata is ignored and the plugin
+ * must use the C plugin loader.
+ *
+ * |[
+ * static void
+ * my_plugin_register_types (PeasObjectModule *module)
+ * {
+ *   peas_object_module_register_extension_type (module,
+ *                                               PEAS_TYPE_ACTIVATABLE,
+ *                                               MY_TYPE_PLUGIN);
+ * }
+ *
+ * PEAS_DEFINE_STATIC_PLUGIN ("my-plugin",
+ *                            "[Plugin]\n"
+ *                            "Name=My Plugin\n"
+ *                            "Builtin=true\n",
+ *                            my_plugin_register_types)
+ * ]|
+ *
+ * This requires a compiler that supports constructors,
+ * otherwise use peas_static_plugin_register() directly.
+ * The name of @register_func must be unique in the program
+ * as a global symbol is derived from it when using MSVC.
+ *
+ * Since: 1.22
+ */
+#ifdef _PEAS_STATIC_PLUGIN_CONSTRUCTOR
+#define PEAS_DEFINE_STATIC_PLUGIN(module_name, metadata, register_func) \
+  static PeasStaticPlugin register_func##_static_plugin = { \
+    (module_name), (metadata), (register_func), NULL \
+  }; \
+  _PEAS_STATIC_PLUGIN_CONSTRUCTOR (register_func##_static_plugin_register) \
+  { \
+    peas_static_plugin_register (&register_func##_static_plugin); \
+  }
+#endif
+
+G_END_DECLS
+
+#endif /* __PEAS_STATIC_PLUGIN_H__ */
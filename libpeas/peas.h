@@ -28,5 +28,7 @@
 #include "peas-extension-set.h"
 #include "peas-object-module.h"
 #include "peas-plugin-info.h"
+#include "peas-plugin-item.h"
+#include "peas-static-plugin.h"
 
 #endif
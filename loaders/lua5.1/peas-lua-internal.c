@@ -33,6 +33,18 @@
 static gpointer hooks_key = NULL;
 static gpointer failed_err_key = NULL;
 
+/* The methods of the Hooks table are stored in the
+ * registry so calling them does not need a string lookup
+ */
+static gpointer hook_keys[PEAS_LUA_INTERNAL_N_HOOKS] = { NULL };
+
+static const gchar *hook_names[PEAS_LUA_INTERNAL_N_HOOKS] = {
+  "load",
+  "find_extension_type",
+  "setup_extension",
+  "garbage_collect"
+};
+
 
 static int
 failed_fn (lua_State *L)
@@ -57,6 +69,8 @@ failed_fn (lua_State *L)
 gboolean
 peas_lua_internal_setup (lua_State *L)
 {
+  guint i;
+
   if (!peas_lua_utils_load_resource (L, "internal.lua", 0, 1))
     {
       /* Already warned */
@@ -82,6 +96,27 @@ peas_lua_internal_setup (lua_State *L)
   lua_pushvalue (L, -2);
   lua_rawset (L, LUA_REGISTRYINDEX);
 
+  for (i = 0; i < PEAS_LUA_INTERNAL_N_HOOKS; ++i)
+    {
+      /* Set registry[&hook_keys[i]] = hooks[hook_names[i]] */
+      lua_pushlightuserdata (L, &hook_keys[i]);
+      lua_getfield (L, -2, hook_names[i]);
+
+      if (!lua_isfunction (L, -1))
+        {
+          g_warning ("Invalid internal Lua hook '%s': "
+                     "expected function, got: %s", hook_names[i],
+                     lua_typename (L, lua_type (L, -1)));
+
+          /* Pop the key, the hook and hooks */
+          lua_pop (L, 3);
+          peas_lua_internal_shutdown (L);
+          return FALSE;
+        }
+
+      lua_rawset (L, LUA_REGISTRYINDEX);
+    }
+
   /* Pop hooks */
   lua_pop (L, -1);
   return TRUE;
@@ -90,26 +125,40 @@ peas_lua_internal_setup (lua_State *L)
 void
 peas_lua_internal_shutdown (lua_State *L)
 {
+  guint i;
+
+  for (i = 0; i < PEAS_LUA_INTERNAL_N_HOOKS; ++i)
+    {
+      lua_pushlightuserdata (L, &hook_keys[i]);
+      lua_pushnil (L);
+      lua_rawset (L, LUA_REGISTRYINDEX);
+    }
+
   lua_pushlightuserdata (L, &hooks_key);
   lua_pushnil (L);
   lua_rawset (L, LUA_REGISTRYINDEX);
 }
 
 gboolean
-peas_lua_internal_call (lua_State   *L,
-                        const gchar *name,
-                        guint        n_args,
-                        gint         return_type)
+peas_lua_internal_call (lua_State           *L,
+                        PeasLuaInternalHook  hook,
+                        guint                n_args,
+                        gint                 return_type)
 {
-  /* Get the Hooks table */
-  lua_pushlightuserdata (L, &hooks_key);
-  lua_rawget (L, LUA_REGISTRYINDEX);
+  const gchar *name;
+
+  g_return_val_if_fail (hook < PEAS_LUA_INTERNAL_N_HOOKS, FALSE);
+
+  name = hook_names[hook];
+  luaL_checkstack (L, 2, "");
 
   /* Get the method */
-  lua_getfield (L, -1, name);
+  lua_pushlightuserdata (L, &hook_keys[hook]);
+  lua_rawget (L, LUA_REGISTRYINDEX);
 
-  /* Swap the method and the table */
-  lua_insert (L, -2);
+  /* Get the Hooks table */
+  lua_pushlightuserdata (L, &hooks_key);
+  lua_rawget (L, LUA_REGISTRYINDEX);
 
   if (n_args > 0)
     {
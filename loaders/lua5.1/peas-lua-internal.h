@@ -27,13 +27,22 @@
 
 G_BEGIN_DECLS
 
-gboolean  peas_lua_internal_setup    (lua_State   *L);
-void      peas_lua_internal_shutdown (lua_State   *L);
+typedef enum {
+  PEAS_LUA_INTERNAL_HOOK_LOAD,
+  PEAS_LUA_INTERNAL_HOOK_FIND_EXTENSION_TYPE,
+  PEAS_LUA_INTERNAL_HOOK_SETUP_EXTENSION,
+  PEAS_LUA_INTERNAL_HOOK_GARBAGE_COLLECT,
 
-gboolean  peas_lua_internal_call     (lua_State   *L,
-                                      const gchar *name,
-                                      guint        n_args,
-                                      gint         return_type);
+  PEAS_LUA_INTERNAL_N_HOOKS
+} PeasLuaInternalHook;
+
+gboolean  peas_lua_internal_setup    (lua_State           *L);
+void      peas_lua_internal_shutdown (lua_State           *L);
+
+gboolean  peas_lua_internal_call     (lua_State           *L,
+                                      PeasLuaInternalHook  hook,
+                                      guint                n_args,
+                                      gint                 return_type);
 
 G_END_DECLS
 
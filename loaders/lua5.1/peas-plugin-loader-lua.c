@@ -36,6 +36,11 @@
 #include "peas-lua-utils.h"
 
 
+/* Enough for any of the internal hooks and the
+ * lgi calls they make without regrowing the stack
+ */
+#define THREAD_STACK_SIZE 64
+
 typedef void (* LgiLockFunc) (gpointer lgi_lock);
 
 
@@ -87,6 +92,11 @@ thread_enter (PeasPluginLoaderLua *lua_loader,
       NL = lua_newthread (L);
       lua_rawset (L, LUA_REGISTRYINDEX);
 
+      /* The thread is kept until the plugin is
+       * unloaded so only grow its stack once
+       */
+      luaL_checkstack (NL, THREAD_STACK_SIZE, "");
+
       info->loader_data = NL;
     }
 
@@ -120,7 +130,8 @@ find_lua_extension_type (lua_State      *L,
   lua_pushstring (L, info->filename);
   lua_pushlightuserdata (L, GSIZE_TO_POINTER (exten_type));
 
-  if (peas_lua_internal_call (L, "find_extension_type",
+  if (peas_lua_internal_call (L,
+                              PEAS_LUA_INTERNAL_HOOK_FIND_EXTENSION_TYPE,
                               2, LUA_TLIGHTUSERDATA))
     {
       GType extension_type;
@@ -187,7 +198,8 @@ peas_plugin_loader_lua_create_extension (PeasPluginLoader *loader,
   lua_pushlightuserdata (L, object);
   lua_pushlightuserdata (L, info);
 
-  if (!peas_lua_internal_call (L, "setup_extension", 2, LUA_TNIL))
+  if (!peas_lua_internal_call (L, PEAS_LUA_INTERNAL_HOOK_SETUP_EXTENSION,
+                               2, LUA_TNIL))
     g_clear_object (&object);
 
 out:
@@ -211,7 +223,8 @@ peas_plugin_loader_lua_load (PeasPluginLoader *loader,
   lua_pushstring (L, peas_plugin_info_get_module_dir (info));
   lua_pushstring (L, peas_plugin_info_get_module_name (info));
 
-  if (peas_lua_internal_call (L, "load", 3, LUA_TBOOLEAN))
+  if (peas_lua_internal_call (L, PEAS_LUA_INTERNAL_HOOK_LOAD,
+                              3, LUA_TBOOLEAN))
     {
       success = lua_toboolean (L, -1);
       lua_pop (L, 1);
@@ -253,7 +266,8 @@ peas_plugin_loader_lua_garbage_collect (PeasPluginLoader *loader)
 
   priv->lgi_enter_func (priv->lgi_lock);
 
-  peas_lua_internal_call (L, "garbage_collect", 0, LUA_TNIL);
+  peas_lua_internal_call (L, PEAS_LUA_INTERNAL_HOOK_GARBAGE_COLLECT,
+                          0, LUA_TNIL);
 
   priv->lgi_leave_func (priv->lgi_lock);
 }
@@ -43,6 +43,22 @@ typedef struct {
   guint must_finalize_python : 1;
 } PeasPluginLoaderPythonPrivate;
 
+/* Stored as the loader_data of the PeasPluginInfo */
+typedef struct {
+  PyObject *pymodule;
+
+  /* Maps every type provided by the module's extensions
+   * to the extension's type, built when it is loaded. It is
+   * never modified afterwards so it is used without the GIL
+   */
+  GHashTable *extension_types;
+} PythonPlugin;
+
+/* Protects the loader_data of the PeasPluginInfos, as it is
+ * read without the GIL while another thread could unload it
+ */
+static GMutex loader_data_lock;
+
 G_DEFINE_TYPE_WITH_PRIVATE (PeasPluginLoaderPython,
                             peas_plugin_loader_python,
                             PEAS_TYPE_PLUGIN_LOADER)
@@ -60,29 +76,90 @@ peas_register_types (PeasObjectModule *module)
                                               PEAS_TYPE_PLUGIN_LOADER_PYTHON);
 }
 
-static GType
-find_python_extension_type (GType     exten_type,
-                            PyObject *pymodule)
+static void
+add_extension_type (GHashTable *extension_types,
+                    GType       provided_type,
+                    GType       the_type)
 {
-  PyObject *pyexten_type, *pytype;
-  GType the_type = G_TYPE_INVALID;
+  /* The first extension found for a type is used */
+  if (!g_hash_table_contains (extension_types,
+                              GSIZE_TO_POINTER (provided_type)))
+    {
+      g_hash_table_insert (extension_types,
+                           GSIZE_TO_POINTER (provided_type),
+                           GSIZE_TO_POINTER (the_type));
+    }
+}
+
+static GHashTable *
+build_extension_types (PyObject *pymodule)
+{
+  PyObject *pytypes;
+  GHashTable *extension_types;
+  Py_ssize_t i;
 
-  pyexten_type = pyg_type_wrapper_new (exten_type);
+  pytypes = peas_python_internal_callv ("get_extension_types", &PyList_Type,
+                                        &pymodule, 1);
+  if (pytypes == NULL)
+    return NULL;
 
-  pytype = peas_python_internal_call ("find_extension_type",
-                                      &PyType_Type, "(OO)",
-                                      pyexten_type, pymodule);
-  Py_DECREF (pyexten_type);
+  extension_types = g_hash_table_new (g_direct_hash, g_direct_equal);
 
-  if (pytype != NULL)
+  for (i = 0; i < PyList_GET_SIZE (pytypes); ++i)
     {
-      the_type = pyg_type_from_object (pytype);
-      Py_DECREF (pytype);
+      GType the_type, provided_type;
+      GType *interfaces;
+      guint j, n_interfaces;
+
+      the_type = pyg_type_from_object (PyList_GET_ITEM (pytypes, i));
+      if (the_type == G_TYPE_INVALID)
+        {
+          PyErr_Clear ();
+          continue;
+        }
+
+      for (provided_type = the_type; provided_type != G_TYPE_INVALID;
+           provided_type = g_type_parent (provided_type))
+        {
+          add_extension_type (extension_types, provided_type, the_type);
+        }
 
-      g_return_val_if_fail (g_type_is_a (the_type, exten_type),
-                            G_TYPE_INVALID);
+      interfaces = g_type_interfaces (the_type, &n_interfaces);
+
+      for (j = 0; j < n_interfaces; ++j)
+        add_extension_type (extension_types, interfaces[j], the_type);
+
+      g_free (interfaces);
     }
 
+  Py_DECREF (pytypes);
+  return extension_types;
+}
+
+static GType
+find_python_extension_type (GType           exten_type,
+                            PeasPluginInfo *info)
+{
+  PythonPlugin *pyplugin;
+  GHashTable *extension_types = NULL;
+  GType the_type;
+
+  /* Keep the index alive in case the plugin is unloaded meanwhile */
+  g_mutex_lock (&loader_data_lock);
+
+  pyplugin = info->loader_data;
+  if (pyplugin != NULL)
+    extension_types = g_hash_table_ref (pyplugin->extension_types);
+
+  g_mutex_unlock (&loader_data_lock);
+
+  if (extension_types == NULL)
+    return G_TYPE_INVALID;
+
+  the_type = (GType) GPOINTER_TO_SIZE (g_hash_table_lookup (extension_types,
+                                                            GSIZE_TO_POINTER (exten_type)));
+
+  g_hash_table_unref (extension_types);
   return the_type;
 }
 
@@ -91,37 +168,24 @@ peas_plugin_loader_python_provides_extension (PeasPluginLoader *loader,
                                               PeasPluginInfo   *info,
                                               GType             exten_type)
 {
-  PyObject *pymodule = info->loader_data;
-  GType the_type;
-  PyGILState_STATE state = PyGILState_Ensure ();
-
-  the_type = find_python_extension_type (exten_type, pymodule);
-
-  PyGILState_Release (state);
-  return the_type != G_TYPE_INVALID;
+  return find_python_extension_type (exten_type, info) != G_TYPE_INVALID;
 }
 
+/* Must be called with the GIL */
 static PeasExtension *
-peas_plugin_loader_python_create_extension (PeasPluginLoader *loader,
-                                            PeasPluginInfo   *info,
-                                            GType             exten_type,
-                                            guint             n_parameters,
-                                            GParameter       *parameters)
+create_extension (PeasPluginInfo *info,
+                  GType           the_type,
+                  GType           exten_type,
+                  guint           n_parameters,
+                  GParameter     *parameters)
 {
-  PyObject *pymodule = info->loader_data;
-  GType the_type;
-  GObject *object = NULL;
+  GObject *object;
   PyObject *pyobject;
   PyObject *pyplinfo;
-  PyGILState_STATE state = PyGILState_Ensure ();
-
-  the_type = find_python_extension_type (exten_type, pymodule);
-  if (the_type == G_TYPE_INVALID)
-    goto out;
 
   object = g_object_newv (the_type, n_parameters, parameters);
   if (object == NULL)
-    goto out;
+    return NULL;
 
   /* We have to remember which interface we are instantiating
    * for the deprecated peas_extension_get_extension_type().
@@ -147,10 +211,63 @@ peas_plugin_loader_python_create_extension (PeasPluginLoader *loader,
   Py_DECREF (pyplinfo);
   Py_DECREF (pyobject);
 
-out:
+  return object;
+}
+
+static PeasExtension *
+peas_plugin_loader_python_create_extension (PeasPluginLoader *loader,
+                                            PeasPluginInfo   *info,
+                                            GType             exten_type,
+                                            guint             n_parameters,
+                                            GParameter       *parameters)
+{
+  GType the_type;
+  PeasExtension *extension;
+  PyGILState_STATE state;
+
+  /* Avoid waiting for the GIL when the plugin is irrelevant */
+  the_type = find_python_extension_type (exten_type, info);
+  if (the_type == G_TYPE_INVALID)
+    return NULL;
+
+  state = PyGILState_Ensure ();
+
+  extension = create_extension (info, the_type, exten_type,
+                                n_parameters, parameters);
+
+  PyGILState_Release (state);
+  return extension;
+}
+
+static void
+peas_plugin_loader_python_create_extensions (PeasPluginLoader  *loader,
+                                             PeasPluginInfo   **infos,
+                                             guint              n_infos,
+                                             GType              exten_type,
+                                             guint              n_parameters,
+                                             GParameter        *parameters,
+                                             PeasExtension    **extensions)
+{
+  guint i;
+  PyGILState_STATE state;
+
+  /* Only take the GIL once for all of the extensions */
+  state = PyGILState_Ensure ();
+
+  for (i = 0; i < n_infos; ++i)
+    {
+      GType the_type;
+
+      the_type = find_python_extension_type (exten_type, infos[i]);
+
+      if (the_type == G_TYPE_INVALID)
+        extensions[i] = NULL;
+      else
+        extensions[i] = create_extension (infos[i], the_type, exten_type,
+                                          n_parameters, parameters);
+    }
 
   PyGILState_Release (state);
-  return object;
 }
 
 static gboolean
@@ -161,6 +278,7 @@ peas_plugin_loader_python_load (PeasPluginLoader *loader,
   PeasPluginLoaderPythonPrivate *priv = GET_PRIV (pyloader);
   const gchar *module_dir, *module_name;
   PyObject *pymodule;
+  GHashTable *extension_types = NULL;
   PyGILState_STATE state = PyGILState_Ensure ();
 
   module_dir = peas_plugin_info_get_module_dir (info);
@@ -172,12 +290,29 @@ peas_plugin_loader_python_load (PeasPluginLoader *loader,
 
   if (pymodule != NULL)
     {
-      info->loader_data = pymodule;
-      priv->n_loaded_plugins += 1;
+      extension_types = build_extension_types (pymodule);
+
+      if (extension_types != NULL)
+        {
+          PythonPlugin *pyplugin = g_slice_new (PythonPlugin);
+
+          pyplugin->pymodule = pymodule;
+          pyplugin->extension_types = extension_types;
+
+          g_mutex_lock (&loader_data_lock);
+          info->loader_data = pyplugin;
+          g_mutex_unlock (&loader_data_lock);
+
+          priv->n_loaded_plugins += 1;
+        }
+      else
+        {
+          Py_DECREF (pymodule);
+        }
     }
 
   PyGILState_Release (state);
-  return pymodule != NULL;
+  return extension_types != NULL;
 }
 
 static void
@@ -186,15 +321,25 @@ peas_plugin_loader_python_unload (PeasPluginLoader *loader,
 {
   PeasPluginLoaderPython *pyloader = PEAS_PLUGIN_LOADER_PYTHON (loader);
   PeasPluginLoaderPythonPrivate *priv = GET_PRIV (pyloader);
+  PythonPlugin *pyplugin;
   PyGILState_STATE state = PyGILState_Ensure ();
 
+  /* The index is only freed once nobody is using it */
+  g_mutex_lock (&loader_data_lock);
+  pyplugin = info->loader_data;
+  info->loader_data = NULL;
+  g_mutex_unlock (&loader_data_lock);
+
   /* We have to use this as a hook as the
    * loader will not be finalized by applications
    */
   if (--priv->n_loaded_plugins == 0)
     peas_python_internal_call ("all_plugins_unloaded", NULL, NULL);
 
-  Py_CLEAR (info->loader_data);
+  Py_DECREF (pyplugin->pymodule);
+  g_hash_table_unref (pyplugin->extension_types);
+  g_slice_free (PythonPlugin, pyplugin);
+
   PyGILState_Release (state);
 }
 
@@ -218,6 +363,12 @@ peas_plugin_loader_python_initialize (PeasPluginLoader *loader)
 
   /* We can't support multiple Python interpreter states:
    * https://bugzilla.gnome.org/show_bug.cgi?id=677091
+   *
+   * This includes the sub-interpreters with their own GIL of
+   * Python 3.12, PyGObject uses single-phase initialization and
+   * keeps its wrappers in the GObjects, which are shared by every
+   * interpreter. Free-threaded builds of Python need no special
+   * handling as PyGILState_Ensure() only attaches the thread.
    */
 
   /* Python initialization */
@@ -257,9 +408,13 @@ peas_plugin_loader_python_initialize (PeasPluginLoader *loader)
       goto python_init_error;
     }
 
-  /* Initialize support for threads */
+  /* Initialize support for threads, since Python 3.7
+   * the GIL is always created by Py_Initialize()
+   */
   pyg_enable_threads ();
+#if PY_VERSION_HEX < 0x03070000
   PyEval_InitThreads ();
+#endif
 
   /* Only redirect warnings when python was not already initialized */
   if (!priv->must_finalize_python)
@@ -348,6 +503,7 @@ peas_plugin_loader_python_class_init (PeasPluginLoaderPythonClass *klass)
   loader_class->load = peas_plugin_loader_python_load;
   loader_class->unload = peas_plugin_loader_python_unload;
   loader_class->create_extension = peas_plugin_loader_python_create_extension;
+  loader_class->create_extensions = peas_plugin_loader_python_create_extensions;
   loader_class->provides_extension = peas_plugin_loader_python_provides_extension;
   loader_class->garbage_collect = peas_plugin_loader_python_garbage_collect;
 }
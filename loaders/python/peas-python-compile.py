@@ -17,28 +17,38 @@
 # Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.
 
 import marshal
+import os
 import sys
 import traceback
 
+try:
+    from importlib.util import MAGIC_NUMBER
+
+except ImportError:
+    import imp
+    MAGIC_NUMBER = imp.get_magic()
+
 
 def compile_file(filename, output):
     """Byte-compiles a Python source file to Python bytecode.
 
-       Unlike py_compile the output is not prefixed
-       by a magic value, mtime or size.
+       Unlike py_compile the output is only prefixed by the magic
+       value and not by the mtime or size. The code object uses
+       the basename of the file as its filename.
     """
-    # Open with universal newlines
-    with open(filename, 'U') as f:
-        code = f.read() + '\n'
+    # compile() handles all newlines and the coding of the source
+    with open(filename, 'rb') as f:
+        code = f.read() + b'\n'
 
     try:
-        code_object = compile(code, filename, 'exec')
+        code_object = compile(code, os.path.basename(filename), 'exec')
 
     except (SyntaxError, TypeError) as error:
         tb = traceback.format_exc(0).rstrip('\n')
         raise Exception('Failed to compile "{0}":\n{1}'.format(filename, tb))
 
     with open(output, 'wb') as f:
+        f.write(MAGIC_NUMBER)
         marshal.dump(code_object, f)
         f.flush()
 
@@ -27,9 +27,18 @@
 
 #include <gio/gio.h>
 
+/* Not included by Python.h */
+#include <marshal.h>
+
+#if PY_MAJOR_VERSION < 3
+#define INTERNAL_RESOURCE_PATH "/org/gnome/libpeas/loaders/python/"
+#else
+#define INTERNAL_RESOURCE_PATH "/org/gnome/libpeas/loaders/python3/"
+#endif
 
 static PyObject *internal_module = NULL;
 static PyObject *internal_hooks = NULL;
+static PyObject *internal_hook_methods = NULL;
 static PyObject *FailedError = NULL;
 
 
@@ -60,6 +69,48 @@ static PyMethodDef failed_method_def = {
   "Prints warning and raises an Exception"
 };
 
+static PyObject *
+load_internal_bytecode (void)
+{
+  GBytes *internal_bytecode;
+  const guint8 *data;
+  gsize size;
+  guint32 magic;
+  PyObject *code = NULL;
+
+  internal_bytecode = g_resources_lookup_data (INTERNAL_RESOURCE_PATH
+                                               "internal.pyc",
+                                               G_RESOURCE_LOOKUP_FLAGS_NONE,
+                                               NULL);
+  if (internal_bytecode == NULL)
+    return NULL;
+
+  data = g_bytes_get_data (internal_bytecode, &size);
+
+  /* The bytecode is only prefixed by the magic value, it is not
+   * usable if the Python we are running in is not the one that
+   * compiled it, the source is compiled instead
+   */
+  if (size > 4)
+    {
+      magic = data[0] | (data[1] << 8) | (data[2] << 16) |
+              ((guint32) data[3] << 24);
+
+      if (magic == (guint32) PyImport_GetMagicNumber ())
+        {
+          code = PyMarshal_ReadObjectFromString ((char *) data + 4,
+                                                 size - 4);
+        }
+    }
+
+  if (code != NULL && !PyCode_Check (code))
+    Py_CLEAR (code);
+
+  PyErr_Clear ();
+  g_bytes_unref (internal_bytecode);
+  return code;
+}
+
 gboolean
 peas_python_internal_setup (gboolean already_initialized)
 {
@@ -89,28 +140,23 @@ peas_python_internal_setup (gboolean already_initialized)
 
   goto_error_if_failed (builtins_module != NULL);
 
-  /* We don't use the byte-compiled Python source
-   * because glib-compile-resources cannot output
-   * depends for generated files.
-   *
-   * https://bugzilla.gnome.org/show_bug.cgi?id=673101
-   */
-  internal_python = g_resources_lookup_data ("/org/gnome/libpeas/loaders/"
-#if PY_MAJOR_VERSION < 3
-                                             "python/"
-#else
-                                             "python3/"
-#endif
-                                             "internal.py",
-                                             G_RESOURCE_LOOKUP_FLAGS_NONE,
-                                             NULL);
-  goto_error_if_failed (internal_python != NULL);
+  /* Avoid compiling the source at every startup */
+  code = load_internal_bytecode ();
 
-  /* Compile it manually so the filename is available */
-  code = Py_CompileString (g_bytes_get_data (internal_python, NULL),
-                           "peas-python-internal.py",
-                           Py_file_input);
-  goto_error_if_failed (code != NULL);
+  if (code == NULL)
+    {
+      internal_python = g_resources_lookup_data (INTERNAL_RESOURCE_PATH
+                                                 "internal.py",
+                                                 G_RESOURCE_LOOKUP_FLAGS_NONE,
+                                                 NULL);
+      goto_error_if_failed (internal_python != NULL);
+
+      /* Compile it manually so the filename is available */
+      code = Py_CompileString (g_bytes_get_data (internal_python, NULL),
+                               "peas-python-internal.py",
+                               Py_file_input);
+      goto_error_if_failed (code != NULL);
+    }
 
   internal_module = PyModule_New ("libpeas-internal");
   goto_error_if_failed (internal_module != NULL);
@@ -153,6 +199,9 @@ peas_python_internal_setup (gboolean already_initialized)
   goto_error_if_failed (PyObject_SetAttrString (internal_hooks, "failed",
                                                 failed_method) == 0);
 
+  internal_hook_methods = PyDict_New ();
+  goto_error_if_failed (internal_hook_methods != NULL);
+
   success = TRUE;
 
 #undef goto_error_if_failed
@@ -167,6 +216,7 @@ error:
     {
       FailedError = NULL;
       internal_hooks = NULL;
+      Py_CLEAR (internal_hook_methods);
 
       if (internal_module != NULL)
         {
@@ -185,36 +235,46 @@ peas_python_internal_shutdown (void)
 
   FailedError = NULL;
   internal_hooks = NULL;
+  Py_CLEAR (internal_hook_methods);
   PyDict_Clear (PyModule_GetDict (internal_module));
   Py_DECREF (internal_module);
 }
 
-PyObject *
-peas_python_internal_call (const gchar  *name,
-                           PyTypeObject *return_type,
-                           const gchar  *format,
-                           ...)
+/* The bound methods are only looked up once */
+static PyObject *
+get_hook_method (const gchar *name)
 {
-  PyObject *args;
-  PyObject *result = NULL;
-  va_list var_args;
+  PyObject *method;
 
-  /* The PyTypeObject for Py_None is not exposed directly */
-  if (return_type == NULL)
-    return_type = Py_None->ob_type;
+  method = PyDict_GetItemString (internal_hook_methods, name);
+  if (method != NULL)
+    return method;
 
-  va_start (var_args, format);
-  args = Py_VaBuildValue (format == NULL ? "()" : format, var_args);
-  va_end (var_args);
+  method = PyObject_GetAttrString (internal_hooks, name);
+  if (method == NULL)
+    return NULL;
 
-  if (args != NULL)
+  if (PyDict_SetItemString (internal_hook_methods, name, method) != 0)
     {
-      result = PyObject_CallMethod (internal_hooks, "call", "(sOO)",
-                                    name, args, return_type);
-      Py_DECREF (args);
+      Py_DECREF (method);
+      return NULL;
     }
 
-  if (PyErr_Occurred ())
+  /* Owned by internal_hook_methods */
+  Py_DECREF (method);
+  return method;
+}
+
+static PyObject *
+check_hook_result (const gchar  *name,
+                   PyTypeObject *return_type,
+                   PyObject     *result)
+{
+  /* The PyTypeObject for Py_None is not exposed directly */
+  if (return_type == NULL)
+    return_type = Py_None->ob_type;
+
+  if (result == NULL)
     {
       /* Raised by failed_fn() to prevent printing the exception */
       if (PyErr_ExceptionMatches (FailedError))
@@ -223,15 +283,90 @@ peas_python_internal_call (const gchar  *name,
         }
       else
         {
-          g_warning ("Failed to run internal Python hook 'call'");
+          g_warning ("Failed to run internal Python hook '%s'", name);
           PyErr_Print ();
         }
 
       return NULL;
     }
 
+  /* We always allow None */
   if (result == Py_None)
-    Py_CLEAR (result);
+    {
+      Py_DECREF (result);
+      return NULL;
+    }
+
+  if (!PyObject_TypeCheck (result, return_type))
+    {
+      g_warning ("Failed to run internal Python hook '%s': "
+                 "expected %s, got %s", name,
+                 return_type->tp_name, Py_TYPE (result)->tp_name);
+
+      Py_DECREF (result);
+      return NULL;
+    }
 
   return result;
 }
+
+PyObject *
+peas_python_internal_call (const gchar  *name,
+                           PyTypeObject *return_type,
+                           const gchar  *format,
+                           ...)
+{
+  PyObject *method, *args;
+  PyObject *result = NULL;
+  va_list var_args;
+
+  method = get_hook_method (name);
+
+  va_start (var_args, format);
+  args = Py_VaBuildValue (format == NULL ? "()" : format, var_args);
+  va_end (var_args);
+
+  if (method != NULL && args != NULL)
+    result = PyObject_Call (method, args, NULL);
+
+  Py_XDECREF (args);
+  return check_hook_result (name, return_type, result);
+}
+
+PyObject *
+peas_python_internal_callv (const gchar  *name,
+                            PyTypeObject *return_type,
+                            PyObject    **args,
+                            gsize         n_args)
+{
+  PyObject *method;
+  PyObject *result = NULL;
+
+  method = get_hook_method (name);
+
+  if (method != NULL)
+    {
+#if PY_VERSION_HEX >= 0x03090000
+      result = PyObject_Vectorcall (method, args, n_args, NULL);
+#else
+      PyObject *args_tuple;
+      gsize i;
+
+      args_tuple = PyTuple_New (n_args);
+
+      for (i = 0; args_tuple != NULL && i < n_args; ++i)
+        {
+          Py_INCREF (args[i]);
+          PyTuple_SET_ITEM (args_tuple, i, args[i]);
+        }
+
+      if (args_tuple != NULL)
+        {
+          result = PyObject_Call (method, args_tuple, NULL);
+          Py_DECREF (args_tuple);
+        }
+#endif
+    }
+
+  return check_hook_result (name, return_type, result);
+}
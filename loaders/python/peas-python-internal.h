@@ -39,6 +39,10 @@ PyObject *peas_python_internal_call     (const gchar  *name,
                                          PyTypeObject *return_type,
                                          const gchar  *format,
                                          ...);
+PyObject *peas_python_internal_callv    (const gchar  *name,
+                                         PyTypeObject *return_type,
+                                         PyObject    **args,
+                                         gsize         n_args);
 
 G_END_DECLS
 
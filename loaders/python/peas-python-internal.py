@@ -18,7 +18,9 @@
 
 import gc
 import gettext
+import hashlib
 import importlib
+import marshal
 import os
 import signal
 import sys
@@ -26,12 +28,80 @@ import traceback
 
 from gi.repository import GLib, GObject
 
+try:
+    from importlib.machinery import (FileFinder, SourceFileLoader,
+                                     SourcelessFileLoader,
+                                     ExtensionFileLoader, SOURCE_SUFFIXES,
+                                     BYTECODE_SUFFIXES, EXTENSION_SUFFIXES)
+    from importlib.util import MAGIC_NUMBER
+
+except ImportError:
+    # Python 2 always writes the bytecode next to the source
+    FileFinder = None
+
 
 # Derive from something not normally caught
 class FailedError(BaseException):
     pass
 
 
+if FileFinder is not None:
+    BYTECODE_CACHE_DIR = os.path.join(GLib.get_user_cache_dir(),
+                                      'libpeas', 'python-bytecode')
+
+    class PluginSourceLoader(SourceFileLoader):
+        """Caches the bytecode of the plugins in the user's cache
+           directory, as plugins are often installed in directories
+           which are not writable. There is one cache file for each
+           source file, it starts with the magic number and the hash
+           of the source and is replaced when either of them changes.
+        """
+        def get_code(self, fullname):
+            source_path = self.get_filename(fullname)
+            source = self.get_data(source_path)
+
+            key = hashlib.sha1(source_path.encode('utf-8', 'surrogateescape'))
+            cache_path = os.path.join(BYTECODE_CACHE_DIR, key.hexdigest())
+
+            header = MAGIC_NUMBER + hashlib.sha1(source).digest()
+
+            try:
+                with open(cache_path, 'rb') as f:
+                    if f.read(len(header)) == header:
+                        return marshal.load(f)
+
+            except (OSError, EOFError, ValueError, TypeError):
+                pass
+
+            code = self.source_to_code(source, source_path)
+
+            if not sys.dont_write_bytecode:
+                self.__write_cache(cache_path, header, code)
+
+            return code
+
+        @staticmethod
+        def __write_cache(cache_path, header, code):
+            tmp_path = '%s.%i' % (cache_path, os.getpid())
+
+            try:
+                os.makedirs(BYTECODE_CACHE_DIR, exist_ok=True)
+
+                with open(tmp_path, 'wb') as f:
+                    f.write(header)
+                    marshal.dump(code, f)
+
+                # Never let another process read a partial file
+                os.replace(tmp_path, cache_path)
+
+            except OSError:
+                try:
+                    os.unlink(tmp_path)
+
+                except OSError:
+                    pass
+
+
 class Hooks(object):
     def __init__(self):
         if not ALREADY_INITIALIZED:
@@ -46,7 +116,11 @@ class Hooks(object):
         gettext.install(GETTEXT_PACKAGE, PEAS_LOCALEDIR)
 
         self.__module_cache = {}
-        self.__extension_cache = {}
+
+        self.__module_dirs = set()
+
+        if FileFinder is not None:
+            sys.path_hooks.insert(0, self.__path_hook)
 
     @staticmethod
     def failed():
@@ -66,24 +140,19 @@ class Hooks(object):
 
         return ''.join(formatted)
 
-    def call(self, name, args, return_type):
-        try:
-            result = getattr(self, name)(*args)
-
-        except FailedError:
-            raise
-
-        except:
-            self.failed("Failed to run internal Python hook '%s':\n%s" %
-                        (name, traceback.format_exc()))
+    def __path_hook(self, path):
+        """Uses PluginSourceLoader for the plugins' directories"""
+        for module_dir in self.__module_dirs:
+            if path == module_dir or path.startswith(module_dir + os.sep):
+                break
 
-        # We always allow None
-        if result is not None and not isinstance(result, return_type):
-            self.failed("Failed to run internal Python hook '%s': "
-                        "expected %s, got %s" %
-                        (name, return_type, result))
+        else:
+            raise ImportError('Not a plugin directory')
 
-        return result
+        return FileFinder(path,
+                          (ExtensionFileLoader, EXTENSION_SUFFIXES),
+                          (PluginSourceLoader, SOURCE_SUFFIXES),
+                          (SourcelessFileLoader, BYTECODE_SUFFIXES))
 
     def load(self, filename, module_dir, module_name):
         try:
@@ -98,6 +167,10 @@ class Hooks(object):
                         "module name '%s' has already been used" %
                         (filename, module_name))
 
+        if module_dir not in self.__module_dirs:
+            self.__module_dirs.add(module_dir)
+            sys.path_importer_cache.pop(module_dir, None)
+
         if module_dir not in sys.path:
             sys.path.insert(0, module_dir)
 
@@ -109,38 +182,22 @@ class Hooks(object):
             self.failed("Error importing plugin '%s':\n%s" %
                         (module_name, self.format_plugin_exception()))
 
-        else:
-            self.__extension_cache[module] = {}
-
         finally:
             self.__module_cache[filename] = module
 
         return module
 
-    def find_extension_type(self, gtype, module):
-        module_gtypes = self.__extension_cache[module]
-
-        try:
-            return module_gtypes[gtype]
-
-        except KeyError:
-            pass
+    @staticmethod
+    def get_extension_types(module):
+        extension_types = []
 
         for key in getattr(module, '__all__', module.__dict__):
             value = getattr(module, key)
 
-            try:
-                value_gtype = value.__gtype__
-
-            except AttributeError:
-                continue
+            if isinstance(value, type) and issubclass(value, GObject.Object):
+                extension_types.append(value)
 
-            if GObject.type_is_a(value_gtype, gtype):
-                module_gtypes[gtype] = value
-                return value
-
-        module_gtypes[gtype] = None
-        return None
+        return extension_types
 
     def garbage_collect(self):
         gc.collect()
@@ -149,6 +206,9 @@ class Hooks(object):
         pass
 
     def exit(self):
+        if FileFinder is not None:
+            sys.path_hooks.remove(self.__path_hook)
+
         gc.collect()
 
 
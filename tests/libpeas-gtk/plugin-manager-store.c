@@ -24,6 +24,7 @@
 #endif
 
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <gtk/gtk.h>
 #include <libpeas/peas.h>
 #include <libpeas-gtk/peas-gtk.h>
@@ -120,6 +121,56 @@ test_gtk_plugin_manager_store_plugin_unloaded (TestFixture *fixture)
   g_assert (!peas_gtk_plugin_manager_store_get_enabled (fixture->store, &iter));
 }
 
+static void
+notify_count_cb (GObject    *object,
+                 GParamSpec *pspec,
+                 guint      *count)
+{
+  ++(*count);
+}
+
+static void
+verify_all_enabled (TestFixture *fixture,
+                    gboolean     enabled)
+{
+  GtkTreeIter iter;
+
+  g_assert (gtk_tree_model_get_iter_first (fixture->model, &iter));
+
+  do
+    {
+      if (peas_gtk_plugin_manager_store_can_enable (fixture->store, &iter))
+        {
+          g_assert_cmpint (peas_gtk_plugin_manager_store_get_enabled (fixture->store,
+                                                                      &iter),
+                           ==, enabled);
+        }
+    }
+  while (gtk_tree_model_iter_next (fixture->model, &iter));
+}
+
+static void
+test_gtk_plugin_manager_store_set_all_disabled (TestFixture *fixture)
+{
+  guint n_notifies = 0;
+
+  g_assert (peas_engine_load_plugin (fixture->engine,
+                                     peas_engine_get_plugin_info (fixture->engine,
+                                                                  "loadable")));
+  g_assert (peas_engine_load_plugin (fixture->engine,
+                                     peas_engine_get_plugin_info (fixture->engine,
+                                                                  "configurable")));
+
+  g_signal_connect (fixture->engine, "notify::loaded-plugins",
+                    G_CALLBACK (notify_count_cb), &n_notifies);
+
+  peas_gtk_plugin_manager_store_set_all_enabled (fixture->store, FALSE);
+  verify_all_enabled (fixture, FALSE);
+
+  /* Unloading is a single batch */
+  g_assert_cmpuint (n_notifies, ==, 1);
+}
+
 static void
 verify_model (TestFixture    *fixture,
               PeasPluginInfo *info,
@@ -315,6 +366,95 @@ test_gtk_plugin_manager_store_invalid_stock_icon (TestFixture *fixture)
                G_TYPE_THEMED_ICON);
 }
 
+static void
+test_gtk_plugin_manager_store_icon_theme_changed (TestFixture *fixture)
+{
+  verify_icon (fixture, "valid-custom-icon", "exists.png", G_TYPE_FILE_ICON);
+
+  /* The cached icons are resolved again */
+  g_signal_emit_by_name (gtk_icon_theme_get_default (), "changed");
+
+  verify_icon (fixture, "valid-custom-icon", "exists.png", G_TYPE_FILE_ICON);
+  verify_icon (fixture, "invalid-custom-icon", "libpeas-plugin",
+               G_TYPE_THEMED_ICON);
+}
+
+static void
+test_gtk_plugin_manager_store_icon_on_demand (TestFixture *fixture)
+{
+  PeasPluginInfo *info;
+  gchar *tmp_dir, *plugin_filename, *data_dir, *icon_filename;
+  GError *error = NULL;
+
+  tmp_dir = g_dir_make_tmp ("libpeas-gtk-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  plugin_filename = g_build_filename (tmp_dir, "on-demand.plugin", NULL);
+  g_file_set_contents (plugin_filename,
+                       "[Plugin]\nModule=on-demand\nName=On Demand\n"
+                       "Icon=on-demand.png\n", -1, &error);
+  g_assert_no_error (error);
+
+  /* The row is added without looking up the icon */
+  peas_engine_add_search_path (fixture->engine, tmp_dir, NULL);
+
+  info = peas_engine_get_plugin_info (fixture->engine, "on-demand");
+  g_assert (info != NULL);
+
+  data_dir = g_strdup (peas_plugin_info_get_data_dir (info));
+  g_assert_cmpint (g_mkdir (data_dir, 0755), ==, 0);
+
+  icon_filename = g_build_filename (data_dir, "on-demand.png", NULL);
+  g_file_set_contents (icon_filename, "", -1, &error);
+  g_assert_no_error (error);
+
+  verify_icon (fixture, "on-demand", "on-demand.png", G_TYPE_FILE_ICON);
+
+  /* The row keeps its icon until it is updated */
+  g_assert_cmpint (g_unlink (icon_filename), ==, 0);
+  verify_icon (fixture, "on-demand", "on-demand.png", G_TYPE_FILE_ICON);
+
+  g_signal_emit_by_name (gtk_icon_theme_get_default (), "changed");
+  verify_icon (fixture, "on-demand", "libpeas-plugin", G_TYPE_THEMED_ICON);
+
+  g_assert_cmpint (g_rmdir (data_dir), ==, 0);
+  g_assert_cmpint (g_unlink (plugin_filename), ==, 0);
+  g_assert_cmpint (g_rmdir (tmp_dir), ==, 0);
+
+  g_free (icon_filename);
+  g_free (data_dir);
+  g_free (plugin_filename);
+  g_free (tmp_dir);
+}
+
+static void
+test_gtk_plugin_manager_store_search (TestFixture *fixture)
+{
+  GtkTreeIter iter;
+  PeasPluginInfo *info;
+
+  info = peas_engine_get_plugin_info (fixture->engine, "configurable");
+  g_assert (peas_gtk_plugin_manager_store_get_iter_from_plugin (fixture->store,
+                                                                &iter, info));
+
+#define MATCHES(key) \
+  (peas_gtk_plugin_manager_store_matches_search (fixture->store, &iter, key))
+
+  /* Name */
+  g_assert (MATCHES ("Conf"));
+  g_assert (MATCHES ("configurable"));
+
+  /* Description and authors */
+  g_assert (MATCHES ("LOAD"));
+  g_assert (MATCHES ("regier"));
+
+  /* Only the start of words */
+  g_assert (!MATCHES ("onfig"));
+  g_assert (!MATCHES ("does-not-exist"));
+
+#undef MATCHES
+}
+
 static void
 test_gtk_plugin_manager_store_hidden (TestFixture *fixture)
 {
@@ -344,6 +484,7 @@ main (int    argc,
 
   TEST ("plugin-loaded", plugin_loaded);
   TEST ("plugin-unloaded", plugin_unloaded);
+  TEST ("set-all-disabled", set_all_disabled);
 
   TEST ("verify-loadable", verify_loadable);
   TEST ("verify-unavailable", verify_unavailable);
@@ -354,6 +495,10 @@ main (int    argc,
   TEST ("valid-stock-icon", valid_stock_icon);
   TEST ("invalid-custom-icon", invalid_custom_icon);
   TEST ("invalid-stock-icon", invalid_stock_icon);
+  TEST ("icon-theme-changed", icon_theme_changed);
+  TEST ("icon-on-demand", icon_on_demand);
+
+  TEST ("search", search);
 
   TEST ("hidden", hidden);
 
@@ -23,11 +23,16 @@
 #include <config.h>
 #endif
 
+#include <string.h>
+
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <gtk/gtk.h>
 #include <libpeas/peas.h>
 #include <libpeas-gtk/peas-gtk.h>
 
+#include "libpeas-gtk/peas-gtk-plugin-manager-store.h"
+
 #include "testing/testing.h"
 
 typedef struct _TestFixture TestFixture;
@@ -193,6 +198,158 @@ test_gtk_plugin_manager_view_reload (TestFixture *fixture)
   g_assert (testing_get_plugin_info_for_iter (fixture->view, &iter) == removed_info);
 }
 
+typedef struct {
+  gint n_inserted;
+  gint n_deleted;
+} RowChanges;
+
+static void
+row_inserted_cb (GtkTreeModel *model,
+                 GtkTreePath  *path,
+                 GtkTreeIter  *iter,
+                 RowChanges   *changes)
+{
+  changes->n_inserted++;
+}
+
+static void
+row_deleted_cb (GtkTreeModel *model,
+                GtkTreePath  *path,
+                RowChanges   *changes)
+{
+  changes->n_deleted++;
+}
+
+static gboolean
+watch_timeout_cb (gpointer user_data)
+{
+  g_assert_not_reached ();
+  return G_SOURCE_REMOVE;
+}
+
+static const gchar *
+get_watched_name (TestFixture *fixture)
+{
+  PeasPluginInfo *info;
+
+  info = peas_engine_get_plugin_info (fixture->engine, "watched");
+
+  return info == NULL ? NULL : peas_plugin_info_get_name (info);
+}
+
+static void
+write_watched_plugin (const gchar *filename,
+                      const gchar *name)
+{
+  gchar *contents;
+  GError *error = NULL;
+
+  contents = g_strdup_printf ("[Plugin]\nModule=watched\nName=%s\n", name);
+  g_file_set_contents (filename, contents, -1, &error);
+  g_assert_no_error (error);
+  g_free (contents);
+}
+
+static void
+test_gtk_plugin_manager_view_incremental_update (TestFixture *fixture)
+{
+  GtkTreeIter iter, kept_iter;
+  PeasPluginInfo *info, *selected_info, *kept_info;
+  RowChanges changes = { 0, 0 };
+  gchar *tmp_dir, *filename, *markup;
+  guint timeout_id;
+  GError *error = NULL;
+
+  /* Select a plugin and keep the iter of another one */
+  g_assert (gtk_tree_model_get_iter_first (fixture->model, &iter));
+  gtk_tree_selection_select_iter (fixture->selection, &iter);
+  selected_info = testing_get_plugin_info_for_iter (fixture->view, &iter);
+
+  g_assert (gtk_tree_model_iter_next (fixture->model, &iter));
+  kept_info = testing_get_plugin_info_for_iter (fixture->view, &iter);
+  kept_iter = iter;
+  convert_iter_to_child_iter (fixture->view, &kept_iter);
+
+  g_signal_connect (fixture->store, "row-inserted",
+                    G_CALLBACK (row_inserted_cb), &changes);
+  g_signal_connect (fixture->store, "row-deleted",
+                    G_CALLBACK (row_deleted_cb), &changes);
+
+  tmp_dir = g_dir_make_tmp ("libpeas-gtk-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  filename = g_build_filename (tmp_dir, "watched.plugin", NULL);
+
+  peas_engine_set_watch_search_paths (fixture->engine, TRUE);
+  peas_engine_add_search_path (fixture->engine, tmp_dir, NULL);
+
+  /* Nothing changed so no row is touched */
+  peas_engine_rescan_plugins (fixture->engine);
+  g_assert_cmpint (changes.n_inserted, ==, 0);
+  g_assert_cmpint (changes.n_deleted, ==, 0);
+
+  timeout_id = g_timeout_add_seconds (10, watch_timeout_cb, NULL);
+
+  /* Adding a plugin only inserts its row */
+  write_watched_plugin (filename, "Watched");
+
+  while (g_strcmp0 (get_watched_name (fixture), "Watched") != 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpint (changes.n_inserted, ==, 1);
+  g_assert_cmpint (changes.n_deleted, ==, 0);
+
+  /* Changing a plugin replaces its PeasPluginInfo,
+   * which can be allocated at the same address
+   */
+  write_watched_plugin (filename, "Changed");
+
+  while (g_strcmp0 (get_watched_name (fixture), "Changed") != 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpint (changes.n_inserted, ==, 2);
+  g_assert_cmpint (changes.n_deleted, ==, 1);
+
+  info = peas_engine_get_plugin_info (fixture->engine, "watched");
+  g_assert (testing_get_iter_for_plugin_info (fixture->view, info, &iter));
+
+  gtk_tree_model_get (fixture->model, &iter,
+                      PEAS_GTK_PLUGIN_MANAGER_STORE_INFO_COLUMN, &markup,
+                      -1);
+  g_assert (strstr (markup, "Changed") != NULL);
+  g_free (markup);
+
+  /* Removing a plugin only removes its row */
+  g_assert_cmpint (g_unlink (filename), ==, 0);
+
+  while (get_watched_name (fixture) != NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpint (changes.n_inserted, ==, 2);
+  g_assert_cmpint (changes.n_deleted, ==, 2);
+
+  g_source_remove (timeout_id);
+
+  /* The other rows and the selection were kept */
+  g_assert (gtk_tree_selection_get_selected (fixture->selection, NULL, &iter));
+  g_assert (testing_get_plugin_info_for_iter (fixture->view,
+                                              &iter) == selected_info);
+
+  gtk_tree_model_get (GTK_TREE_MODEL (fixture->store), &kept_iter,
+                      PEAS_GTK_PLUGIN_MANAGER_STORE_PLUGIN_COLUMN, &info,
+                      -1);
+  g_assert (info == kept_info);
+
+  g_signal_handlers_disconnect_by_func (fixture->store,
+                                        row_inserted_cb, &changes);
+  g_signal_handlers_disconnect_by_func (fixture->store,
+                                        row_deleted_cb, &changes);
+
+  g_assert_cmpint (g_rmdir (tmp_dir), ==, 0);
+  g_free (filename);
+  g_free (tmp_dir);
+}
+
 static void
 test_gtk_plugin_manager_view_enable_plugin (TestFixture *fixture)
 {
@@ -237,6 +394,126 @@ test_gtk_plugin_manager_view_enable_builtin_plugin (TestFixture *fixture)
   gtk_tree_path_free (path);
 }
 
+static void
+info_cell_data_func (GtkTreeViewColumn *column,
+                     GtkCellRenderer   *cell,
+                     GtkTreeModel      *model,
+                     GtkTreeIter       *iter,
+                     GHashTable        *shown)
+{
+  PeasPluginInfo *info;
+
+  gtk_tree_model_get (model, iter,
+                      PEAS_GTK_PLUGIN_MANAGER_STORE_PLUGIN_COLUMN, &info,
+                      -1);
+  g_hash_table_add (shown, info);
+}
+
+static gboolean
+draw_cb (GtkWidget *widget,
+         cairo_t   *cr,
+         gboolean  *drawn)
+{
+  *drawn = TRUE;
+  return FALSE;
+}
+
+static void
+test_gtk_plugin_manager_view_only_shown_rows (TestFixture *fixture)
+{
+  GtkWidget *window, *scrolled_window;
+  GtkTreeViewColumn *column;
+  GList *cells;
+  GHashTable *shown;
+  GtkTreeIter iter;
+  PeasPluginInfo *last_info = NULL;
+  gchar *tmp_dir;
+  gint i, n_rows = 0;
+  gboolean drawn = FALSE;
+  guint timeout_id;
+  GError *error = NULL;
+
+  tmp_dir = g_dir_make_tmp ("libpeas-gtk-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  for (i = 0; i < 100; ++i)
+    {
+      gchar *filename, *contents;
+
+      filename = g_strdup_printf ("%s/many-%03d.plugin", tmp_dir, i);
+      contents = g_strdup_printf ("[Plugin]\nModule=many-%03d\n"
+                                  "Name=Many %03d\n"
+                                  "Description=One of many plugins.\n",
+                                  i, i);
+      g_file_set_contents (filename, contents, -1, &error);
+      g_assert_no_error (error);
+      g_free (contents);
+      g_free (filename);
+    }
+
+  peas_engine_add_search_path (fixture->engine, tmp_dir, NULL);
+
+  /* The info column is requested when the text cell is rendered */
+  shown = g_hash_table_new (g_direct_hash, g_direct_equal);
+  column = gtk_tree_view_get_column (fixture->tree_view, 1);
+  cells = gtk_cell_layout_get_cells (GTK_CELL_LAYOUT (column));
+  gtk_tree_view_column_set_cell_data_func (column,
+                                           GTK_CELL_RENDERER (g_list_last (cells)->data),
+                                           (GtkTreeCellDataFunc) info_cell_data_func,
+                                           shown, NULL);
+  g_list_free (cells);
+
+  scrolled_window = gtk_scrolled_window_new (NULL, NULL);
+  gtk_container_add (GTK_CONTAINER (scrolled_window),
+                     GTK_WIDGET (fixture->tree_view));
+
+  window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+  gtk_window_set_default_size (GTK_WINDOW (window), 200, 100);
+  gtk_container_add (GTK_CONTAINER (window), scrolled_window);
+
+  g_signal_connect_after (fixture->tree_view, "draw",
+                          G_CALLBACK (draw_cb), &drawn);
+
+  timeout_id = g_timeout_add_seconds (10, watch_timeout_cb, NULL);
+  gtk_widget_show_all (window);
+
+  while (!drawn)
+    gtk_main_iteration ();
+
+  g_source_remove (timeout_id);
+
+  g_assert (gtk_tree_model_get_iter_first (fixture->model, &iter));
+
+  do
+    {
+      last_info = testing_get_plugin_info_for_iter (fixture->view, &iter);
+      ++n_rows;
+    }
+  while (gtk_tree_model_iter_next (fixture->model, &iter));
+
+  /* Only the rows which fit in the window were asked for
+   * their markup, not every row to measure its height
+   */
+  g_assert_cmpint (g_hash_table_size (shown), >, 0);
+  g_assert_cmpint (g_hash_table_size (shown), <, n_rows / 2);
+  g_assert (!g_hash_table_contains (shown, last_info));
+
+  gtk_widget_destroy (window);
+  g_hash_table_unref (shown);
+
+  for (i = 0; i < 100; ++i)
+    {
+      gchar *filename;
+
+      filename = g_strdup_printf ("%s/many-%03d.plugin", tmp_dir, i);
+      g_assert_cmpint (g_unlink (filename), ==, 0);
+      g_free (filename);
+    }
+
+  g_assert_cmpint (g_rmdir (tmp_dir), ==, 0);
+  g_free (tmp_dir);
+}
+
 int
 main (int    argc,
       char **argv)
@@ -254,10 +531,13 @@ main (int    argc,
   TEST ("hide-builtin", hide_builtin);
 
   TEST ("reload", reload);
+  TEST ("incremental-update", incremental_update);
 
   TEST ("enable-plugin", enable_plugin);
   TEST ("enable-builtin-plugin", enable_builtin_plugin);
 
+  TEST ("only-shown-rows", only_shown_rows);
+
 #undef TEST
 
   return testing_run_tests ();
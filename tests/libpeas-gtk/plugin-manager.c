@@ -237,6 +237,88 @@ test_gtk_plugin_manager_plugin_unloaded (TestFixture *fixture)
   g_assert (!gtk_widget_is_sensitive (fixture->configure_button));
 }
 
+static void
+test_gtk_plugin_manager_plugin_reloaded (TestFixture *fixture)
+{
+  PeasPluginInfo *info;
+
+  test_gtk_plugin_manager_plugin_unloaded (fixture);
+
+  info = peas_engine_get_plugin_info (fixture->engine, "configurable");
+
+  /* The cached answer must not outlive each load */
+  g_assert (!gtk_widget_is_sensitive (fixture->configure_button));
+  peas_engine_load_plugin (fixture->engine, info);
+  g_assert (gtk_widget_is_sensitive (fixture->configure_button));
+  peas_engine_unload_plugin (fixture->engine, info);
+  g_assert (!gtk_widget_is_sensitive (fixture->configure_button));
+}
+
+static PeasObjectModule *late_configurable_module = NULL;
+
+static GObject *
+late_configurable_factory (guint       n_parameters,
+                           GParameter *parameters,
+                           gpointer    user_data)
+{
+  g_assert_not_reached ();
+  return NULL;
+}
+
+static void
+late_configurable_register_types (PeasObjectModule *module)
+{
+  late_configurable_module = module;
+}
+
+PEAS_DEFINE_STATIC_PLUGIN ("late-configurable",
+                           "[Plugin]\n"
+                           "Name=Late Configurable\n"
+                           "Description=A plugin that becomes configurable "
+                           "after it is loaded.\n",
+                           late_configurable_register_types)
+
+static void
+test_gtk_plugin_manager_configurable_cached (TestFixture *fixture)
+{
+  gint i;
+  GtkTreeIter iter, other_iter;
+  PeasPluginInfo *info, *other_info;
+
+  info = peas_engine_get_plugin_info (fixture->engine, "late-configurable");
+  g_assert (peas_engine_load_plugin (fixture->engine, info));
+  g_assert (late_configurable_module != NULL);
+
+  other_info = peas_engine_get_plugin_info (fixture->engine, "configurable");
+  g_assert (testing_get_iter_for_plugin_info (fixture->view, info, &iter));
+  g_assert (testing_get_iter_for_plugin_info (fixture->view, other_info,
+                                              &other_iter));
+
+  gtk_tree_selection_select_iter (fixture->selection, &iter);
+  g_assert (!gtk_widget_is_sensitive (fixture->configure_button));
+
+  /* The engine now answers differently, but only a reload
+   * may ask it again so the button must stay insensitive
+   */
+  peas_object_module_register_extension_factory (late_configurable_module,
+                                                 PEAS_GTK_TYPE_CONFIGURABLE,
+                                                 late_configurable_factory,
+                                                 NULL, NULL);
+  g_assert (peas_engine_provides_extension (fixture->engine, info,
+                                            PEAS_GTK_TYPE_CONFIGURABLE));
+
+  for (i = 0; i < 3; ++i)
+    {
+      gtk_tree_selection_select_iter (fixture->selection, &other_iter);
+      gtk_tree_selection_select_iter (fixture->selection, &iter);
+      g_assert (!gtk_widget_is_sensitive (fixture->configure_button));
+    }
+
+  g_assert (peas_engine_unload_plugin (fixture->engine, info));
+  g_assert (peas_engine_load_plugin (fixture->engine, info));
+  g_assert (gtk_widget_is_sensitive (fixture->configure_button));
+}
+
 static void
 test_gtk_plugin_manager_about_dialog (TestFixture *fixture)
 {
@@ -397,6 +479,8 @@ main (int    argc,
 
   TEST ("plugin-loaded", plugin_loaded);
   TEST ("plugin-unloaded", plugin_unloaded);
+  TEST ("plugin-reloaded", plugin_reloaded);
+  TEST ("configurable-cached", configurable_cached);
 
   TEST ("about-dialog", about_dialog);
   TEST ("configure-dialog", configure_dialog);
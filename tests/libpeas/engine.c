@@ -25,6 +25,7 @@
 
 #include <stdlib.h>
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <libpeas/peas.h>
 
 #include "libpeas/peas-engine-priv.h"
@@ -215,6 +216,50 @@ test_engine_unload_plugin_with_dep (PeasEngine *engine)
   g_assert (!peas_plugin_info_is_loaded (info));
 }
 
+static void
+unload_plugin_order_cb (PeasEngine     *engine,
+                        PeasPluginInfo *info,
+                        GPtrArray      *unloaded)
+{
+  g_ptr_array_add (unloaded, info);
+}
+
+static void
+test_engine_unload_plugin_with_chained_dep (PeasEngine *engine)
+{
+  PeasPluginInfo *loadable_info, *has_dep_info, *chained_dep_info;
+  GPtrArray *unloaded;
+
+  loadable_info = peas_engine_get_plugin_info (engine, "loadable");
+  has_dep_info = peas_engine_get_plugin_info (engine, "has-dep");
+  chained_dep_info = peas_engine_get_plugin_info (engine, "chained-dep");
+
+  g_assert (peas_engine_load_plugin (engine, chained_dep_info));
+  g_assert (peas_plugin_info_is_loaded (has_dep_info));
+  g_assert (peas_plugin_info_is_loaded (loadable_info));
+
+  /* The default handler unloads the dependants
+   * so it has finished once ours is called
+   */
+  unloaded = g_ptr_array_new ();
+  g_signal_connect_after (engine, "unload-plugin",
+                          G_CALLBACK (unload_plugin_order_cb), unloaded);
+
+  g_assert (peas_engine_unload_plugin (engine, loadable_info));
+  g_assert (!peas_plugin_info_is_loaded (loadable_info));
+  g_assert (!peas_plugin_info_is_loaded (has_dep_info));
+  g_assert (!peas_plugin_info_is_loaded (chained_dep_info));
+
+  g_assert_cmpuint (unloaded->len, ==, 3);
+  g_assert (g_ptr_array_index (unloaded, 0) == chained_dep_info);
+  g_assert (g_ptr_array_index (unloaded, 1) == has_dep_info);
+  g_assert (g_ptr_array_index (unloaded, 2) == loadable_info);
+
+  g_signal_handlers_disconnect_by_func (engine, unload_plugin_order_cb,
+                                        unloaded);
+  g_ptr_array_unref (unloaded);
+}
+
 static void
 test_engine_unload_plugin_with_self_dep (PeasEngine *engine)
 {
@@ -228,6 +273,41 @@ test_engine_unload_plugin_with_self_dep (PeasEngine *engine)
   g_assert (!peas_plugin_info_is_loaded (info));
 }
 
+static void
+test_engine_get_dependants (PeasEngine *engine)
+{
+  PeasPluginInfo *info;
+  GList *dependants;
+
+  info = peas_engine_get_plugin_info (engine, "loadable");
+  dependants = peas_engine_get_dependants (engine, info);
+
+  /* chained-dep only depends on loadable through has-dep */
+  g_assert_cmpuint (g_list_length (dependants), ==, 3);
+  g_assert (g_list_find (dependants,
+                         peas_engine_get_plugin_info (engine, "has-dep")));
+  g_assert (g_list_find (dependants,
+                         peas_engine_get_plugin_info (engine, "two-deps")));
+  g_assert (g_list_find (dependants,
+                         peas_engine_get_plugin_info (engine, "chained-dep")));
+  g_list_free (dependants);
+
+  info = peas_engine_get_plugin_info (engine, "has-dep");
+  dependants = peas_engine_get_dependants (engine, info);
+
+  g_assert_cmpuint (g_list_length (dependants), ==, 1);
+  g_assert (dependants->data ==
+            peas_engine_get_plugin_info (engine, "chained-dep"));
+  g_list_free (dependants);
+
+  /* A plugin is never its own dependant */
+  info = peas_engine_get_plugin_info (engine, "self-dep");
+  g_assert (peas_engine_get_dependants (engine, info) == NULL);
+
+  info = peas_engine_get_plugin_info (engine, "chained-dep");
+  g_assert (peas_engine_get_dependants (engine, info) == NULL);
+}
+
 static void
 test_engine_unavailable_plugin (PeasEngine *engine)
 {
@@ -295,6 +375,85 @@ test_engine_plugin_list (PeasEngine *engine)
   g_assert_cmpint (loadable_index, <, two_deps_index);
 }
 
+static void
+items_changed_cb (GListModel *model,
+                  guint       position,
+                  guint       removed,
+                  guint       added,
+                  gint       *changed_position)
+{
+  g_assert_cmpuint (removed, ==, 0);
+  g_assert_cmpuint (added, ==, 1);
+
+  *changed_position = position;
+}
+
+static void
+test_engine_plugin_model (PeasEngine *engine)
+{
+  GListModel *model = G_LIST_MODEL (engine);
+  const GList *plugin_list;
+  PeasPluginItem *item, *other_item;
+  PeasPluginInfo *info;
+  gchar *tmp_dir, *filename;
+  gint changed_position = -1;
+  guint i;
+  GError *error = NULL;
+
+  g_assert (g_list_model_get_item_type (model) == PEAS_TYPE_PLUGIN_ITEM);
+
+  plugin_list = peas_engine_get_plugin_list (engine);
+  g_assert_cmpuint (g_list_model_get_n_items (model), ==,
+                    g_list_length ((GList *) plugin_list));
+
+  for (i = 0; plugin_list != NULL; plugin_list = plugin_list->next, ++i)
+    {
+      item = g_list_model_get_item (model, i);
+      g_assert (peas_plugin_item_get_plugin_info (item) == plugin_list->data);
+
+      /* The same item must be returned every time */
+      other_item = g_list_model_get_item (model, i);
+      g_assert (other_item == item);
+
+      g_object_unref (other_item);
+      g_object_unref (item);
+    }
+
+  g_assert (g_list_model_get_item (model, i) == NULL);
+
+  tmp_dir = g_dir_make_tmp ("libpeas-engine-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  filename = g_build_filename (tmp_dir, "model.plugin", NULL);
+  g_file_set_contents (filename,
+                       "[Plugin]\n"
+                       "Module=model\n"
+                       "Name=Model\n", -1, &error);
+  g_assert_no_error (error);
+
+  g_signal_connect (engine, "items-changed",
+                    G_CALLBACK (items_changed_cb), &changed_position);
+
+  peas_engine_add_search_path (engine, tmp_dir, NULL);
+  peas_engine_rescan_plugins (engine);
+
+  info = peas_engine_get_plugin_info (engine, "model");
+  g_assert (info != NULL);
+
+  g_assert_cmpint (changed_position, ==,
+                   g_list_index ((GList *) peas_engine_get_plugin_list (engine),
+                                 info));
+
+  item = g_list_model_get_item (model, changed_position);
+  g_assert (peas_plugin_item_get_plugin_info (item) == info);
+  g_object_unref (item);
+
+  g_assert_cmpint (g_unlink (filename), ==, 0);
+  g_assert_cmpint (g_rmdir (tmp_dir), ==, 0);
+  g_free (filename);
+  g_free (tmp_dir);
+}
+
 static void
 load_plugin_cb (PeasEngine     *engine,
                 PeasPluginInfo *info,
@@ -434,6 +593,106 @@ test_engine_nonexistent_search_path (PeasEngine *engine)
   peas_engine_add_search_path (engine, "/nowhere", NULL);
 }
 
+static void
+plugin_added_cb (PeasEngine      *engine,
+                 PeasPluginInfo  *info,
+                 guint            position,
+                 PeasPluginInfo **added)
+{
+  g_assert (g_list_nth_data ((GList *) peas_engine_get_plugin_list (engine),
+                             position) == info);
+
+  *added = info;
+}
+
+static void
+plugin_removed_cb (PeasEngine      *engine,
+                   PeasPluginInfo  *info,
+                   PeasPluginInfo **removed)
+{
+  g_assert (g_list_find ((GList *) peas_engine_get_plugin_list (engine),
+                         info) == NULL);
+
+  *removed = info;
+}
+
+static gboolean
+watch_timeout_cb (gpointer user_data)
+{
+  g_assert_not_reached ();
+  return G_SOURCE_REMOVE;
+}
+
+static void
+test_engine_watch_search_paths (PeasEngine *engine)
+{
+  gchar *tmp_dir, *filename;
+  guint timeout_id;
+  PeasPluginInfo *added = NULL, *removed = NULL;
+  GError *error = NULL;
+
+  tmp_dir = g_dir_make_tmp ("libpeas-engine-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  filename = g_build_filename (tmp_dir, "watched.plugin", NULL);
+
+  g_signal_connect (engine, "plugin-added",
+                    G_CALLBACK (plugin_added_cb), &added);
+  g_signal_connect (engine, "plugin-removed",
+                    G_CALLBACK (plugin_removed_cb), &removed);
+
+  peas_engine_set_watch_search_paths (engine, TRUE);
+  g_assert (peas_engine_get_watch_search_paths (engine));
+
+  peas_engine_add_search_path (engine, tmp_dir, NULL);
+  g_assert (peas_engine_get_plugin_info (engine, "watched") == NULL);
+
+  timeout_id = g_timeout_add_seconds (10, watch_timeout_cb, NULL);
+
+  /* Adding a plugin */
+  g_file_set_contents (filename,
+                       "[Plugin]\n"
+                       "Module=watched\n"
+                       "Name=Watched\n", -1, &error);
+  g_assert_no_error (error);
+
+  while (added == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert (added == peas_engine_get_plugin_info (engine, "watched"));
+  g_assert_cmpstr (peas_plugin_info_get_name (added), ==, "Watched");
+
+  /* Changing a plugin */
+  added = NULL;
+  g_file_set_contents (filename,
+                       "[Plugin]\n"
+                       "Module=watched\n"
+                       "Name=Changed\n", -1, &error);
+  g_assert_no_error (error);
+
+  while (added == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert (removed != NULL);
+  g_assert (added == peas_engine_get_plugin_info (engine, "watched"));
+  g_assert_cmpstr (peas_plugin_info_get_name (added), ==, "Changed");
+
+  /* Removing a plugin */
+  removed = NULL;
+  g_assert_cmpint (g_unlink (filename), ==, 0);
+
+  while (removed == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert (peas_engine_get_plugin_info (engine, "watched") == NULL);
+
+  g_source_remove (timeout_id);
+
+  g_assert_cmpint (g_rmdir (tmp_dir), ==, 0);
+  g_free (filename);
+  g_free (tmp_dir);
+}
+
 static void
 test_engine_shutdown (void)
 {
@@ -482,18 +741,23 @@ main (int    argc,
 
   TEST ("unload-plugin", unload_plugin);
   TEST ("unload-plugin-with-dep", unload_plugin_with_dep);
+  TEST ("unload-plugin-with-chained-dep", unload_plugin_with_chained_dep);
   TEST ("unload-plugin-with-self-dep", unload_plugin_with_self_dep);
 
+  TEST ("get-dependants", get_dependants);
+
   TEST ("unavailable-plugin", unavailable_plugin);
   TEST ("not-loadable-plugin", not_loadable_plugin);
 
   TEST ("plugin-list", plugin_list);
+  TEST ("plugin-model", plugin_model);
   TEST ("loaded-plugins", loaded_plugins);
 
   TEST ("enable-unkown-loader", enable_unkown_loader);
   TEST ("enable-loader-multiple-times", enable_loader_multiple_times);
 
   TEST ("nonexistent-search-path", nonexistent_search_path);
+  TEST ("watch-search-paths", watch_search_paths);
 
   TEST_FUNC ("shutdown", shutdown);
   TEST ("shutdown/subprocess", shutdown_subprocess);
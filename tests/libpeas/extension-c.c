@@ -32,6 +32,13 @@
 #include "plugins/embedded/embedded-resources.h"
 
 
+PEAS_DEFINE_STATIC_PLUGIN ("static",
+                           "[Plugin]\n"
+                           "Name=Static\n"
+                           "Description=A plugin that is linked in.\n"
+                           "Authors=Garrett Regier\n",
+                           testing_embedded_plugin_register_types)
+
 static void
 test_extension_c_embedded (PeasEngine *engine)
 {
@@ -88,6 +95,44 @@ test_extension_c_embedded_missing_symbol (PeasEngine *engine)
   g_assert (!peas_engine_load_plugin (engine, info));
 }
 
+static void
+test_extension_c_static (PeasEngine *engine)
+{
+  PeasPluginInfo *info;
+  PeasExtension *extension;
+
+  info = peas_engine_get_plugin_info (engine, "static");
+  g_assert (info != NULL);
+
+  /* Check that the various data is correct */
+  g_assert (!peas_plugin_info_is_loaded (info));
+  g_assert (peas_plugin_info_is_available (info, NULL));
+  g_assert (!peas_plugin_info_is_builtin (info));
+  g_assert (!peas_plugin_info_is_hidden (info));
+  g_assert_cmpstr (peas_plugin_info_get_module_name (info), ==, "static");
+  g_assert_cmpstr (peas_plugin_info_get_name (info), ==, "Static");
+  g_assert_cmpstr (peas_plugin_info_get_module_dir (info), ==, "static://");
+  g_assert_cmpstr (peas_plugin_info_get_data_dir (info), ==,
+                   "static://static");
+  g_assert (info->embedded == NULL);
+  g_assert (info->static_plugin != NULL);
+
+  g_assert (peas_engine_load_plugin (engine, info));
+  g_assert (peas_plugin_info_is_loaded (info));
+  g_assert (peas_engine_unload_plugin (engine, info));
+  g_assert (!peas_plugin_info_is_loaded (info));
+  g_assert (peas_engine_load_plugin (engine, info));
+  g_assert (peas_plugin_info_is_loaded (info));
+
+  extension = peas_engine_create_extension (engine, info,
+                                            PEAS_TYPE_ACTIVATABLE,
+                                            NULL);
+
+  g_assert (TESTING_IS_EMBEDDED_PLUGIN (extension));
+
+  g_object_unref (extension);
+}
+
 static void
 test_extension_c_instance_refcount (PeasEngine     *engine,
                                     PeasPluginInfo *info)
@@ -193,6 +238,7 @@ main (int   argc,
 
   EXTENSION_TEST (c, "embedded", embedded);
   EXTENSION_TEST (c, "embedded-missing-symbol", embedded_missing_symbol);
+  EXTENSION_TEST (c, "static", static);
   EXTENSION_TEST (c, "instance-refcount", instance_refcount);
   EXTENSION_TEST (c, "nonexistent", nonexistent);
   EXTENSION_TEST (c, "local-linkage", local_linkage);
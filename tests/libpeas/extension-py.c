@@ -26,11 +26,14 @@
 
 #include <pygobject.h>
 
+#include <glib/gstdio.h>
+
 #include <libpeas/peas-activatable.h>
 #include "libpeas/peas-engine-priv.h"
 
 #include "testing/testing-extension.h"
 #include "introspection/introspection-base.h"
+#include "introspection/introspection-unimplemented.h"
 
 
 #if PY_VERSION_HEX < 0x03000000
@@ -122,6 +125,188 @@ test_extension_py_nonexistent (PeasEngine *engine)
   g_assert (!peas_engine_load_plugin (engine, info));
 }
 
+typedef struct {
+  PeasEngine *engine;
+  PeasPluginInfo *info;
+  gint stop;
+} ProvidesData;
+
+static gpointer
+provides_thread_func (ProvidesData *data)
+{
+  g_assert (peas_engine_provides_extension (data->engine, data->info,
+                                            INTROSPECTION_TYPE_BASE));
+  g_assert (!peas_engine_provides_extension (data->engine, data->info,
+                                             INTROSPECTION_TYPE_UNIMPLEMENTED));
+
+  return NULL;
+}
+
+static void
+test_extension_py_provides_without_gil (PeasEngine     *engine,
+                                        PeasPluginInfo *info)
+{
+  ProvidesData data = { engine, info, FALSE };
+  GThread *thread;
+  PyGILState_STATE state;
+
+  /* Would deadlock if the GIL was needed by the other thread */
+  state = PyGILState_Ensure ();
+
+  thread = g_thread_new ("provides", (GThreadFunc) provides_thread_func,
+                         &data);
+  g_thread_join (thread);
+
+  PyGILState_Release (state);
+}
+
+#if PY_VERSION_HEX >= 0x03030000
+static void
+unload_plugin_event_cb (PeasEngine     *engine,
+                        PeasPluginInfo *info,
+                        PyObject       *events)
+{
+  PyGILState_STATE state = PyGILState_Ensure ();
+  PyObject *name;
+
+  name = PyUnicode_FromString (peas_plugin_info_get_module_name (info));
+  g_assert (PyList_Append (events, name) == 0);
+  Py_DECREF (name);
+
+  PyGILState_Release (state);
+}
+
+static void
+test_extension_py_garbage_collect_batch (PeasEngine     *engine,
+                                         PeasPluginInfo *info)
+{
+  PeasPluginInfo *other_info;
+  gchar *tmp_dir, *plugin_filename, *module_filename;
+  PyObject *module, *dict, *result, *events;
+  PyGILState_STATE state;
+  GError *error = NULL;
+
+  /* A second plugin for the same loader */
+  tmp_dir = g_dir_make_tmp ("libpeas-tests-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  plugin_filename = g_build_filename (tmp_dir, "extension-py-gc.plugin",
+                                      NULL);
+  g_file_set_contents (plugin_filename,
+                       "[Plugin]\nModule=extension_py_gc\n"
+                       "Loader=" PY_LOADER_STR "\nName=GC\n", -1, &error);
+  g_assert_no_error (error);
+
+  module_filename = g_build_filename (tmp_dir, "extension_py_gc.py", NULL);
+  g_file_set_contents (module_filename, "", -1, &error);
+  g_assert_no_error (error);
+
+  peas_engine_add_search_path (engine, tmp_dir, NULL);
+
+  other_info = peas_engine_get_plugin_info (engine, "extension_py_gc");
+  g_assert (peas_engine_load_plugin (engine, other_info));
+
+  /* Record each collection, automatic ones are disabled */
+  state = PyGILState_Ensure ();
+
+  module = PyImport_AddModule ("__main__");
+  dict = PyModule_GetDict (module);
+
+  result = PyRun_String ("import gc\n"
+                         "gc_events = []\n"
+                         "def gc_callback(phase, info):\n"
+                         "    if phase == 'start':\n"
+                         "        gc_events.append('gc')\n"
+                         "gc.disable()\n"
+                         "gc.callbacks.append(gc_callback)\n",
+                         Py_file_input, dict, dict);
+  g_assert (result != NULL);
+  Py_DECREF (result);
+
+  events = PyDict_GetItemString (dict, "gc_events");
+  Py_INCREF (events);
+
+  PyGILState_Release (state);
+
+  g_signal_connect_after (engine, "unload-plugin",
+                          G_CALLBACK (unload_plugin_event_cb), events);
+
+  /* The loader collects once, before the first plugin is unloaded */
+  peas_engine_set_loaded_plugins (engine, NULL);
+
+  g_signal_handlers_disconnect_by_func (engine, unload_plugin_event_cb,
+                                        events);
+
+  state = PyGILState_Ensure ();
+
+  g_assert_cmpint (PyList_Size (events), ==, 3);
+  g_assert (PyUnicode_CompareWithASCIIString (PyList_GetItem (events, 0),
+                                              "gc") == 0);
+  g_assert (PyUnicode_CompareWithASCIIString (PyList_GetItem (events, 1),
+                                              "gc") != 0);
+  g_assert (PyUnicode_CompareWithASCIIString (PyList_GetItem (events, 2),
+                                              "gc") != 0);
+
+  result = PyRun_String ("gc.callbacks.remove(gc_callback)\n"
+                         "gc.enable()\n"
+                         "del gc_callback, gc_events\n",
+                         Py_file_input, dict, dict);
+  g_assert (result != NULL);
+  Py_DECREF (result);
+
+  Py_DECREF (events);
+
+  PyGILState_Release (state);
+
+  g_assert_cmpint (g_unlink (module_filename), ==, 0);
+  g_assert_cmpint (g_unlink (plugin_filename), ==, 0);
+  g_assert_cmpint (g_rmdir (tmp_dir), ==, 0);
+
+  g_free (module_filename);
+  g_free (plugin_filename);
+  g_free (tmp_dir);
+}
+#endif
+
+static gpointer
+provides_while_unloading_thread_func (ProvidesData *data)
+{
+  while (!g_atomic_int_get (&data->stop))
+    {
+      /* Depends on whether the plugin is currently loaded */
+      peas_engine_provides_extension (data->engine, data->info,
+                                      INTROSPECTION_TYPE_BASE);
+    }
+
+  return NULL;
+}
+
+static void
+test_extension_py_provides_while_unloading (PeasEngine     *engine,
+                                            PeasPluginInfo *info)
+{
+  ProvidesData data = { engine, info, FALSE };
+  GThread *thread;
+  gint i;
+
+  thread = g_thread_new ("provides",
+                         (GThreadFunc) provides_while_unloading_thread_func,
+                         &data);
+
+  /* The other thread must never see a freed plugin */
+  for (i = 0; i < 200; ++i)
+    {
+      g_assert (peas_engine_unload_plugin (engine, info));
+      g_assert (peas_engine_load_plugin (engine, info));
+    }
+
+  g_atomic_int_set (&data.stop, TRUE);
+  g_thread_join (thread);
+
+  g_assert (peas_engine_provides_extension (engine, info,
+                                            INTROSPECTION_TYPE_BASE));
+}
+
 static void
 test_extension_py_already_initialized (void)
 {
@@ -176,6 +361,102 @@ test_extension_py_already_initialized_subprocess (void)
   Py_Finalize ();
 }
 
+#if PY_VERSION_HEX >= 0x03000000
+static gchar *
+get_bytecode_cache_file (const gchar *cache_dir)
+{
+  gchar *bytecode_dir, *filename;
+  const gchar *name;
+  GDir *dir;
+  GError *error = NULL;
+
+  bytecode_dir = g_build_filename (cache_dir, "libpeas", "python-bytecode",
+                                   NULL);
+  dir = g_dir_open (bytecode_dir, 0, &error);
+  g_assert_no_error (error);
+
+  /* Only the plugin's module is imported and
+   * it must only ever have a single cache file
+   */
+  name = g_dir_read_name (dir);
+  g_assert (name != NULL);
+  filename = g_build_filename (bytecode_dir, name, NULL);
+  g_assert (g_dir_read_name (dir) == NULL);
+
+  g_dir_close (dir);
+  g_free (bytecode_dir);
+  return filename;
+}
+
+static void
+test_extension_py_bytecode_cache (void)
+{
+  gchar *cache_dir, *cache_file, *cache_file2, *dirname;
+  GStatBuf buf, buf2;
+  GError *error = NULL;
+
+  cache_dir = g_dir_make_tmp ("libpeas-tests-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  g_setenv ("XDG_CACHE_HOME", cache_dir, TRUE);
+
+  /* The first import compiles the plugin and writes the cache */
+  g_test_trap_subprocess (EXTENSION_TEST_NAME (PY_LOADER,
+                                               "bytecode-cache/subprocess"),
+                          0, G_TEST_SUBPROCESS_INHERIT_STDERR);
+  g_test_trap_assert_passed ();
+
+  cache_file = get_bytecode_cache_file (cache_dir);
+  g_assert_cmpint (g_stat (cache_file, &buf), ==, 0);
+
+  /* The second import uses the cache instead of replacing it */
+  g_test_trap_subprocess (EXTENSION_TEST_NAME (PY_LOADER,
+                                               "bytecode-cache/subprocess"),
+                          0, G_TEST_SUBPROCESS_INHERIT_STDERR);
+  g_test_trap_assert_passed ();
+
+  cache_file2 = get_bytecode_cache_file (cache_dir);
+  g_assert_cmpstr (cache_file, ==, cache_file2);
+  g_assert_cmpint (g_stat (cache_file, &buf2), ==, 0);
+  g_assert_cmpuint (buf.st_ino, ==, buf2.st_ino);
+
+  g_assert_cmpint (g_unlink (cache_file), ==, 0);
+
+  dirname = g_path_get_dirname (cache_file);
+  g_assert_cmpint (g_rmdir (dirname), ==, 0);
+  g_free (dirname);
+
+  dirname = g_build_filename (cache_dir, "libpeas", NULL);
+  g_assert_cmpint (g_rmdir (dirname), ==, 0);
+  g_free (dirname);
+
+  g_assert_cmpint (g_rmdir (cache_dir), ==, 0);
+  g_unsetenv ("XDG_CACHE_HOME");
+
+  g_free (cache_file2);
+  g_free (cache_file);
+  g_free (cache_dir);
+}
+
+static void
+test_extension_py_bytecode_cache_subprocess (void)
+{
+  PeasEngine *engine;
+  PeasPluginInfo *info;
+
+  /* Set by testing_util_envars() and read when Python is initialized */
+  g_unsetenv ("PYTHONDONTWRITEBYTECODE");
+
+  engine = testing_engine_new ();
+  peas_engine_enable_loader (engine, PY_LOADER_STR);
+
+  info = peas_engine_get_plugin_info (engine, "extension-" PY_LOADER_STR);
+  g_assert (peas_engine_load_plugin (engine, info));
+
+  testing_engine_free (engine);
+}
+#endif
+
 #if ENABLE_PYTHON2 && ENABLE_PYTHON3
 static void
 test_extension_py_mixed_python (void)
@@ -248,12 +529,27 @@ main (int   argc,
   EXTENSION_TEST (PY_LOADER, "activatable-subject-refcount",
                   activatable_subject_refcount);
 
+  EXTENSION_TEST (PY_LOADER, "provides-without-gil", provides_without_gil);
+  EXTENSION_TEST (PY_LOADER, "provides-while-unloading",
+                  provides_while_unloading);
+
   EXTENSION_TEST (PY_LOADER, "nonexistent", nonexistent);
 
+#if PY_VERSION_HEX >= 0x03030000
+  EXTENSION_TEST (PY_LOADER, "garbage-collect-batch",
+                  garbage_collect_batch);
+#endif
+
   EXTENSION_TEST_FUNC (PY_LOADER, "already-initialized", already_initialized);
   EXTENSION_TEST_FUNC (PY_LOADER, "already-initialized/subprocess",
                        already_initialized_subprocess);
 
+#if PY_VERSION_HEX >= 0x03000000
+  EXTENSION_TEST_FUNC (PY_LOADER, "bytecode-cache", bytecode_cache);
+  EXTENSION_TEST_FUNC (PY_LOADER, "bytecode-cache/subprocess",
+                       bytecode_cache_subprocess);
+#endif
+
 #if ENABLE_PYTHON2 && ENABLE_PYTHON3
   EXTENSION_TEST_FUNC (PY_LOADER, "mixed-python", mixed_python);
   EXTENSION_TEST_FUNC (PY_LOADER, "mixed-python/subprocess",
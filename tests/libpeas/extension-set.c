@@ -41,6 +41,34 @@ static const gchar *loadable_plugins[] = {
   "loadable", "has-dep", "self-dep"
 };
 
+static gint wrong_type_n_created = 0;
+
+static GObject *
+wrong_type_factory (guint       n_parameters,
+                    GParameter *parameters,
+                    gpointer    user_data)
+{
+  ++wrong_type_n_created;
+
+  return g_object_new (G_TYPE_OBJECT, NULL);
+}
+
+static void
+wrong_type_register_types (PeasObjectModule *module)
+{
+  peas_object_module_register_extension_factory (module,
+                                                 PEAS_TYPE_ACTIVATABLE,
+                                                 wrong_type_factory,
+                                                 NULL, NULL);
+}
+
+PEAS_DEFINE_STATIC_PLUGIN ("wrong-type",
+                           "[Plugin]\n"
+                           "Name=Wrong Type\n"
+                           "Description=A plugin that claims to provide "
+                           "a PeasActivatable but returns a GObject.\n",
+                           wrong_type_register_types)
+
 static void
 extension_added_cb (PeasExtensionSet *extension_set,
                     PeasPluginInfo   *info,
@@ -332,6 +360,73 @@ test_extension_set_ordering (PeasEngine *engine)
   g_assert (dispose_order == NULL);
 }
 
+static void
+test_extension_set_create_batch (PeasEngine *engine)
+{
+  guint i;
+  const GList *l;
+  GList *order = NULL;
+  PeasPluginInfo *info;
+  PeasExtensionSet *extension_set;
+
+  testing_util_push_log_hook ("*Plugin 'wrong-type' does not provide a "
+                              "'PeasActivatable' extension");
+
+  for (i = 0; i < G_N_ELEMENTS (loadable_plugins); ++i)
+    {
+      info = peas_engine_get_plugin_info (engine, loadable_plugins[i]);
+      g_assert (peas_engine_load_plugin (engine, info));
+    }
+
+  info = peas_engine_get_plugin_info (engine, "wrong-type");
+  g_assert (peas_engine_load_plugin (engine, info));
+  g_assert (peas_engine_provides_extension (engine, info,
+                                            PEAS_TYPE_ACTIVATABLE));
+
+  /* Load a plugin that does not provide a PeasActivatable */
+  info = peas_engine_get_plugin_info (engine, "extension-c");
+  g_assert (peas_engine_load_plugin (engine, info));
+
+  for (l = peas_engine_get_plugin_list (engine); l != NULL; l = l->next)
+    {
+      info = (PeasPluginInfo *) l->data;
+
+      if (peas_plugin_info_is_loaded (info) &&
+          peas_engine_provides_extension (engine, info,
+                                          PEAS_TYPE_ACTIVATABLE) &&
+          g_strcmp0 (peas_plugin_info_get_module_name (info),
+                     "wrong-type") != 0)
+        {
+          order = g_list_append (order,
+                                 (gpointer) peas_plugin_info_get_module_name (info));
+        }
+    }
+
+  g_assert_cmpint (g_list_length (order), ==,
+                   G_N_ELEMENTS (loadable_plugins));
+
+  /* The extensions of the already loaded plugins are all
+   * created while constructing the set, the one of the
+   * wrong type is dropped and the others are in plugin list order
+   */
+  wrong_type_n_created = 0;
+  extension_set = peas_extension_set_new (engine,
+                                          PEAS_TYPE_ACTIVATABLE,
+                                          "object", NULL,
+                                          NULL);
+  g_assert_cmpint (wrong_type_n_created, ==, 1);
+
+  peas_extension_set_foreach (extension_set,
+                              (PeasExtensionSetForeachFunc) ordering_cb,
+                              &order);
+  g_assert (order == NULL);
+
+  info = peas_engine_get_plugin_info (engine, "wrong-type");
+  g_assert (peas_extension_set_get_extension (extension_set, info) == NULL);
+
+  g_object_unref (extension_set);
+}
+
 int
 main (int    argc,
       char **argv)
@@ -345,6 +440,7 @@ main (int    argc,
 
   TEST ("create-valid", create_valid);
   TEST ("create-invalid", create_invalid);
+  TEST ("create-batch", create_batch);
 
   TEST ("extension-added", extension_added);
   TEST ("extension-removed", extension_removed);
@@ -26,8 +26,11 @@
 #include <stdlib.h>
 
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <libpeas/peas.h>
 
+#include "libpeas/peas-plugin-info-priv.h"
+
 #include "testing/testing.h"
 
 typedef struct _TestFixture TestFixture;
@@ -127,6 +130,33 @@ test_plugin_info_verify_min_info (PeasEngine *engine)
   g_assert (authors != NULL && authors[0] == NULL);
 }
 
+static void
+test_plugin_info_verify_key_file (PeasEngine *engine)
+{
+  PeasPluginInfo *info;
+  const gchar **authors;
+
+  info = peas_engine_get_plugin_info (engine, "info-key-file");
+
+  g_assert (info != NULL);
+  g_assert (peas_plugin_info_is_hidden (info));
+
+  g_assert_cmpstr (peas_plugin_info_get_dependencies (info)[0], ==, NULL);
+
+  g_assert_cmpstr (peas_plugin_info_get_name (info), ==, "Key File Info");
+  g_assert_cmpstr (peas_plugin_info_get_description (info), ==, "Escaped space and\ttab");
+  g_assert_cmpstr (peas_plugin_info_get_copyright (info), ==, "Line One\nLine Two");
+
+  authors = peas_plugin_info_get_authors (info);
+  g_assert (authors != NULL && authors[2] == NULL);
+  g_assert_cmpstr (authors[0], ==, "First Author");
+  g_assert_cmpstr (authors[1], ==, "Second; Author");
+
+  g_assert_cmpstr (peas_plugin_info_get_external_data (info, "Escaped"), ==, "a\\b");
+  g_assert_cmpstr (peas_plugin_info_get_external_data (info, "Overridden"), ==, "second");
+  g_assert_cmpstr (peas_plugin_info_get_external_data (info, "Missing"), ==, NULL);
+}
+
 static void
 test_plugin_info_has_dep (PeasEngine *engine)
 {
@@ -176,6 +206,303 @@ test_plugin_info_os_dependant_help (PeasEngine *engine)
 #endif
 }
 
+typedef struct {
+  PeasPluginInfo *info;
+  GSettings *settings;
+  gboolean cancelled;
+} GetSettingsData;
+
+static void
+get_settings_async_cb (GObject      *source_object,
+                       GAsyncResult *result,
+                       gpointer      user_data)
+{
+  GetSettingsData *data = user_data;
+  GError *error = NULL;
+
+  data->settings = peas_plugin_info_get_settings_finish (data->info,
+                                                         result, &error);
+  g_assert_no_error (error);
+  g_assert (G_IS_SETTINGS (data->settings));
+}
+
+static void
+test_plugin_info_get_settings_async (PeasEngine *engine)
+{
+  GetSettingsData data = { NULL, NULL, FALSE };
+  gint i;
+
+  data.info = peas_engine_get_plugin_info (engine, "extension-c");
+
+  /* The second time the schema source already exists */
+  for (i = 0; i < 2; ++i)
+    {
+      peas_plugin_info_get_settings_async (data.info, NULL, NULL,
+                                           get_settings_async_cb, &data);
+
+      while (data.settings == NULL)
+        g_main_context_iteration (NULL, TRUE);
+
+      g_clear_object (&data.settings);
+    }
+}
+
+static void
+write_shared_schema_plugins (const gchar  *dir,
+                             const gchar **module_names)
+{
+  GString *schemas;
+  gchar *filename;
+  gint i;
+
+  schemas = g_string_new ("<schemalist>\n");
+
+  for (i = 0; module_names[i] != NULL; ++i)
+    {
+      gchar *contents;
+
+      contents = g_strdup_printf ("[Plugin]\nModule=%s\nName=%s\n",
+                                  module_names[i], module_names[i]);
+      filename = g_strdup_printf ("%s/%s.plugin", dir, module_names[i]);
+      g_assert (g_file_set_contents (filename, contents, -1, NULL));
+      g_free (filename);
+      g_free (contents);
+
+      g_string_append_printf (schemas,
+                              "  <schema id=\"%s\" "
+                              "path=\"/org/gnome/libpeas/tests/%s/\">\n"
+                              "    <key name=\"enabled\" type=\"b\">\n"
+                              "      <default>true</default>\n"
+                              "    </key>\n"
+                              "  </schema>\n",
+                              module_names[i], module_names[i]);
+    }
+
+  g_string_append (schemas, "</schemalist>\n");
+
+  filename = g_build_filename (dir, "shared-schema.gschema.xml", NULL);
+  g_assert (g_file_set_contents (filename, schemas->str, -1, NULL));
+  g_free (filename);
+
+  /* Let peas_plugin_info_get_settings() compile them */
+  filename = g_build_filename (dir, "gschemas.compiled", NULL);
+  g_unlink (filename);
+  g_free (filename);
+
+  g_string_free (schemas, TRUE);
+}
+
+static void
+remove_shared_schema_plugins (const gchar *dir)
+{
+  GDir *gdir;
+  const gchar *name;
+
+  gdir = g_dir_open (dir, 0, NULL);
+  g_assert (gdir != NULL);
+
+  while ((name = g_dir_read_name (gdir)) != NULL)
+    {
+      gchar *filename = g_build_filename (dir, name, NULL);
+
+      g_assert_cmpint (g_unlink (filename), ==, 0);
+      g_free (filename);
+    }
+
+  g_dir_close (gdir);
+  g_assert_cmpint (g_rmdir (dir), ==, 0);
+}
+
+static void
+test_plugin_info_shared_schema_source (PeasEngine *unused)
+{
+  const gchar *module_names[] = {
+    "shared-schema-a", "shared-schema-b", NULL, NULL
+  };
+  gchar *dir;
+  PeasEngine *engine;
+  PeasPluginInfo *info_a, *info_b, *info_c;
+  GSettings *settings_a, *settings_b, *settings_c;
+  GSettingsSchemaSource *source;
+  GError *error = NULL;
+
+  dir = g_dir_make_tmp ("libpeas-tests-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  write_shared_schema_plugins (dir, module_names);
+
+  /* Only these plugins can be found so they must be
+   * freed with the engine and not kept by the fixture
+   */
+  engine = peas_engine_new ();
+  peas_engine_add_search_path (engine, dir, NULL);
+
+  info_a = peas_engine_get_plugin_info (engine, "shared-schema-a");
+  info_b = peas_engine_get_plugin_info (engine, "shared-schema-b");
+
+  settings_a = peas_plugin_info_get_settings (info_a, NULL);
+  settings_b = peas_plugin_info_get_settings (info_b, NULL);
+  g_assert (G_IS_SETTINGS (settings_a));
+  g_assert (G_IS_SETTINGS (settings_b));
+
+  /* Both plugins are in the same module directory */
+  g_assert (info_a->schema_source != NULL);
+  g_assert (info_a->schema_source == info_b->schema_source);
+
+  /* Keep it alive so a new source cannot have the same address */
+  source = g_settings_schema_source_ref (info_a->schema_source);
+
+  g_object_unref (settings_a);
+  g_object_unref (settings_b);
+  g_object_unref (engine);
+
+  /* Both plugins are gone so the source must no longer be shared */
+  engine = peas_engine_new ();
+  peas_engine_add_search_path (engine, dir, NULL);
+
+  info_a = peas_engine_get_plugin_info (engine, "shared-schema-a");
+  settings_a = peas_plugin_info_get_settings (info_a, NULL);
+  g_assert (G_IS_SETTINGS (settings_a));
+  g_assert (info_a->schema_source != source);
+
+  g_settings_schema_source_unref (source);
+
+  /* Adding a plugin recompiles gschemas.compiled, which
+   * must be used even though plugin A still shares a source
+   */
+  module_names[2] = "shared-schema-c";
+  write_shared_schema_plugins (dir, module_names);
+  peas_engine_rescan_plugins (engine);
+
+  info_c = peas_engine_get_plugin_info (engine, "shared-schema-c");
+  g_assert (info_c != NULL);
+
+  settings_c = peas_plugin_info_get_settings (info_c, NULL);
+  g_assert (G_IS_SETTINGS (settings_c));
+  g_assert (info_c->schema_source != info_a->schema_source);
+
+  g_object_unref (settings_a);
+  g_object_unref (settings_c);
+  g_object_unref (engine);
+
+  remove_shared_schema_plugins (dir);
+  g_free (dir);
+}
+
+static void
+test_plugin_info_get_settings_async_compile (PeasEngine *unused)
+{
+  const gchar *module_names[] = { "async-schema", NULL };
+  GetSettingsData data = { NULL, NULL, FALSE };
+  gchar *dir;
+  gchar *gschemas_compiled;
+  PeasEngine *engine;
+  GError *error = NULL;
+
+  dir = g_dir_make_tmp ("libpeas-tests-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  write_shared_schema_plugins (dir, module_names);
+  gschemas_compiled = g_build_filename (dir, "gschemas.compiled", NULL);
+
+  engine = peas_engine_new ();
+  peas_engine_add_search_path (engine, dir, NULL);
+
+  data.info = peas_engine_get_plugin_info (engine, "async-schema");
+
+  /* There is no gschemas.compiled so it must be compiled
+   * by glib-compile-schemas before the settings are returned
+   */
+  g_assert (!g_file_test (gschemas_compiled, G_FILE_TEST_EXISTS));
+
+  peas_plugin_info_get_settings_async (data.info, NULL, NULL,
+                                       get_settings_async_cb, &data);
+
+  while (data.settings == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert (g_file_test (gschemas_compiled, G_FILE_TEST_EXISTS));
+  g_assert (data.info->schema_source != NULL);
+
+  g_clear_object (&data.settings);
+  g_object_unref (engine);
+
+  remove_shared_schema_plugins (dir);
+  g_free (gschemas_compiled);
+  g_free (dir);
+}
+
+static void
+get_settings_cancelled_cb (GObject      *source_object,
+                           GAsyncResult *result,
+                           gpointer      user_data)
+{
+  GetSettingsData *data = user_data;
+  GError *error = NULL;
+
+  data->settings = peas_plugin_info_get_settings_finish (data->info,
+                                                         result, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_assert (data->settings == NULL);
+
+  g_error_free (error);
+  data->cancelled = TRUE;
+}
+
+static void
+test_plugin_info_get_settings_async_cancel (PeasEngine *unused)
+{
+  const gchar *module_names[] = { "async-schema", NULL };
+  GetSettingsData data = { NULL, NULL, FALSE };
+  gchar *dir;
+  gchar *gschemas_compiled;
+  PeasEngine *engine;
+  GCancellable *cancellable;
+  GError *error = NULL;
+
+  dir = g_dir_make_tmp ("libpeas-tests-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  write_shared_schema_plugins (dir, module_names);
+  gschemas_compiled = g_build_filename (dir, "gschemas.compiled", NULL);
+
+  engine = peas_engine_new ();
+  peas_engine_add_search_path (engine, dir, NULL);
+
+  data.info = peas_engine_get_plugin_info (engine, "async-schema");
+
+  cancellable = g_cancellable_new ();
+  peas_plugin_info_get_settings_async (data.info, NULL, cancellable,
+                                       get_settings_cancelled_cb, &data);
+  g_cancellable_cancel (cancellable);
+
+  while (!data.cancelled)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert (data.info->schema_source == NULL);
+  g_object_unref (cancellable);
+
+  /* Cancelling does not kill glib-compile-schemas, wait for it
+   * so the directory can be removed and then check that
+   * the settings can still be created afterwards
+   */
+  while (!g_file_test (gschemas_compiled, G_FILE_TEST_EXISTS))
+    g_usleep (G_USEC_PER_SEC / 100);
+
+  peas_plugin_info_get_settings_async (data.info, NULL, NULL,
+                                       get_settings_async_cb, &data);
+
+  while (data.settings == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_clear_object (&data.settings);
+  g_object_unref (engine);
+
+  remove_shared_schema_plugins (dir);
+  g_free (gschemas_compiled);
+  g_free (dir);
+}
+
 int
 main (int    argc,
       char **argv)
@@ -189,6 +516,7 @@ main (int    argc,
 
   TEST ("verify-full-info", verify_full_info);
   TEST ("verify-min-info", verify_min_info);
+  TEST ("verify-key-file", verify_key_file);
 
   TEST ("has-dep", has_dep);
 
@@ -197,6 +525,11 @@ main (int    argc,
 
   TEST ("os-dependant-help", os_dependant_help);
 
+  TEST ("get-settings-async", get_settings_async);
+  TEST ("shared-schema-source", shared_schema_source);
+  TEST ("get-settings-async-compile", get_settings_async_compile);
+  TEST ("get-settings-async-cancel", get_settings_async_cancel);
+
 #undef TEST
 
   return testing_run_tests ();